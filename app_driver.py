@@ -47,6 +47,7 @@ class SrcTraceParser(tracematch.SrcTraceParser):
     def __init__(self, stream):
         tracematch.SrcTraceParser.__init__(self, stream)
         self.swapbuffers = 0
+        self.blobBytes = 0
 
     def handleCall(self, callNo, functionName, args, ret):
         tracematch.SrcTraceParser.handleCall(self, callNo, functionName, args, ret)
@@ -55,6 +56,10 @@ class SrcTraceParser(tracematch.SrcTraceParser):
            repr(args).find('kCGLPFADoubleBuffer') != -1:
             self.swapbuffers += 1
 
+    def handleBlob(self, length):
+        self.blobBytes += length
+        return tracematch.SrcTraceParser.handleBlob(self, length)
+
 
 class AppDriver(Driver):
 
@@ -187,7 +192,17 @@ class AppDriver(Driver):
     def checkTrace(self):
         sys.stderr.write('Comparing trace %s against %s...\n' % (self.trace_file, self.ref_dump))
 
-        cmd = [options.apitrace, 'dump', '--verbose', '--color=never', self.trace_file]
+        refTrace = None
+        budgets = {}
+        if self.ref_dump:
+            budgets = self.readBudgets()
+            refParser = tracematch.RefTraceParser(self.ref_dump)
+            refTrace = refParser.parse()
+
+        cmd = [options.apitrace, 'dump', '--verbose', '--color=never']
+        if isinstance(refTrace, tracematch.ThreadedTraceMatcher):
+            cmd += ['--thread-ids']
+        cmd += [self.trace_file]
         p = popen(cmd, stdout=subprocess.PIPE, universal_newlines=True)
 
         srcParser = SrcTraceParser(p.stdout)
@@ -197,12 +212,9 @@ class AppDriver(Driver):
         images = []
         states = []
 
-        if self.ref_dump:
-            refParser = tracematch.RefTraceParser(self.ref_dump)
-            refTrace = refParser.parse()
-
+        if refTrace is not None:
             try:
-                mo = refTrace.match(srcTrace)
+                mo = refTrace.match(srcTrace, threads=srcParser.threads, processes=options.match_processes)
             except tracematch.TraceMismatch as ex:
                 fail(str(ex))
 
@@ -231,6 +243,12 @@ class AppDriver(Driver):
         if p.returncode != 0:
             fail('`apitrace dump` returned code %i' % p.returncode)
 
+        self.recordMetric('checkTrace', 'blob_bytes', srcParser.blobBytes, 'bytes')
+        self.checkBudgets(budgets, {
+            'max_trace_size': os.path.getsize(self.trace_file),
+            'max_blob_bytes': srcParser.blobBytes,
+        })
+
         sys.stdout.flush()
         sys.stderr.write('\n')
 
@@ -242,6 +260,45 @@ class AppDriver(Driver):
         for callNo, refStateFileName in states:
             self.checkState(callNo, refStateFileName)
 
+    budget_names = ('max_trace_size', 'max_blob_bytes')
+
+    budget_re = re.compile(r'^//#\s*([_a-z]+)\s+([0-9]+)\s*([KMG]?)\s*$')
+
+    budget_units = {'': 1, 'K': 1 << 10, 'M': 1 << 20, 'G': 1 << 30}
+
+    def readBudgets(self):
+        '''Read the `//#max_trace_size N` and `//#max_blob_bytes N` lines
+        (N optionally suffixed with K, M, or G) from the comments heading the
+        reference dump.'''
+
+        budgets = {}
+        for line in open(self.ref_dump, 'rt'):
+            line = line.strip()
+            if not line.startswith('//'):
+                break
+            if not line.startswith('//#'):
+                continue
+            mo = self.budget_re.match(line)
+            if not mo or mo.group(1) not in self.budget_names:
+                fail('%s: invalid budget %r' % (self.ref_dump, line))
+            name, value, unit = mo.groups()
+            budgets[name] = int(value) * self.budget_units[unit]
+        return budgets
+
+    def checkBudgets(self, budgets, values):
+        '''Fail when the trace got fatter than budgeted, even if its calls
+        still match.'''
+
+        for name in self.budget_names:
+            try:
+                budget = budgets[name]
+            except KeyError:
+                continue
+            value = values[name]
+            sys.stdout.write('%s: %u bytes, budget %u bytes\n' % (name[len('max_'):], value, budget))
+            if value > budget:
+                fail('%s of %u bytes exceeds budget of %u bytes' % (name[len('max_'):], value, budget))
+
     def checkImage(self, callNo, refImageFileName):
         sys.stderr.write('Comparing snapshot from call %u against %s...\n' % (callNo, refImageFileName))
         try:
@@ -456,6 +513,11 @@ class AppDriver(Driver):
             '--ref-dump', metavar='PATH',
             type='string', dest='ref_dump', default=None,
             help='reference dump')
+        optparser.add_option(
+            '--match-processes', metavar='N',
+            type='int', dest='match_processes',
+            default=int(os.environ.get('APITRACE_TESTS_MATCH_PROCESSES', '1')),
+            help='match long dumps against the reference with up to N processes [default: $APITRACE_TESTS_MATCH_PROCESSES, or 1]')
 
         return optparser
 
@@ -475,10 +537,12 @@ class AppDriver(Driver):
         self.ref_dump = options.ref_dump
         self.results = options.results
 
-        self.runApp()
-        self.traceApp()
-        self.checkTrace()
-        self.replay()
+        self.runPhase('runApp', self.runApp)
+        self.runPhase('traceApp', self.traceApp)
+        if self.trace_file is not None and os.path.exists(self.trace_file):
+            self.recordMetric('traceApp', 'trace_size', os.path.getsize(self.trace_file), 'bytes')
+        self.runPhase('checkTrace', self.checkTrace)
+        self.runPhase('replay', self.replay)
 
         pass_()
 
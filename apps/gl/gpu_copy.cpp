@@ -0,0 +1,203 @@
+/**************************************************************************
+ *
+ * Copyright 2026 apitrace-tests contributors
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ **************************************************************************/
+
+/*
+ * Move a large amount of data per frame purely on the GPU, with
+ * glCopyBufferSubData, glCopyImageSubData, glBlitFramebuffer, and
+ * glCopyTexSubImage2D, none of which should make the tracer capture any
+ * data.
+ *
+ * The bottom half of the source texture is unpacked from the copied buffer,
+ * and the top half cleared, so the window ends up green at the bottom and
+ * blue at the top only if every copy is replayed.
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+
+static GLFWwindow* window;
+
+static int frames = 2;
+
+/* Amount of data copied between buffers per frame */
+static int megabytes = 1024;
+
+static const int bufferMegabytes = 64;
+static const GLsizeiptr bufferSize = (GLsizeiptr)bufferMegabytes << 20;
+
+static const GLsizei texSize = 2048;
+
+static const GLubyte green[4] = { 0, 255, 0, 255 };
+static const GLubyte blue[4] = { 0, 0, 255, 255 };
+
+static GLint width, height;
+
+static GLuint buffers[2];
+static GLuint textures[3];
+static GLuint framebuffers[2];
+
+
+static void
+draw(void)
+{
+    int copies = (megabytes + bufferMegabytes - 1) / bufferMegabytes;
+    for (int i = 0; i < copies; ++i) {
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, bufferSize);
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[1]);
+    glBindTexture(GL_TEXTURE_2D, textures[0]);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texSize, texSize/2, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glClearTexSubImage(textures[0], 0, 0, texSize/2, 0, texSize, texSize/2, 1, GL_RGBA, GL_UNSIGNED_BYTE, blue);
+
+    glCopyImageSubData(textures[0], GL_TEXTURE_2D, 0, 0, 0, 0,
+                       textures[1], GL_TEXTURE_2D, 0, 0, 0, 0,
+                       texSize, texSize, 1);
+
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    /* Scale the copied texture onto the left half of the window */
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffers[0]);
+    glBlitFramebuffer(0, 0, texSize, texSize, 0, 0, width/2, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+    /* Copy the left half of the window onto the right half, through a
+     * texture */
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, textures[2]);
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width/2, height);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffers[1]);
+    glBlitFramebuffer(0, 0, width/2, height, width/2, 0, 2*(width/2), height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+    glfwSwapBuffers(window);
+}
+
+
+static void
+init(void)
+{
+    glfwGetFramebufferSize(window, &width, &height);
+    glViewport(0, 0, width, height);
+
+    glClearColor(0.3f, 0.1f, 0.3f, 1.0f);
+
+    glGenBuffers(2, buffers);
+    glBindBuffer(GL_COPY_READ_BUFFER, buffers[0]);
+    glBufferStorage(GL_COPY_READ_BUFFER, bufferSize, NULL, 0);
+    glClearBufferData(GL_COPY_READ_BUFFER, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, green);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[1]);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, bufferSize, NULL, 0);
+
+    glGenTextures(3, textures);
+    for (int i = 0; i < 3; ++i) {
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        if (i < 2) {
+            glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, texSize, texSize);
+        } else {
+            glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width/2, height);
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(2, framebuffers);
+    for (int i = 0; i < 2; ++i) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffers[i]);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textures[i + 1], 0);
+        if (glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            fprintf(stderr, "error: incomplete framebuffer\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+
+static void
+usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [FRAMES [MEGABYTES]]\n", name);
+    exit(EXIT_FAILURE);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    if (argc > 3) {
+        usage(argv[0]);
+    }
+    if (argc >= 2) {
+        frames = atoi(argv[1]);
+        if (frames <= 0) {
+            usage(argv[0]);
+        }
+    }
+    if (argc >= 3) {
+        megabytes = atoi(argv[2]);
+        if (megabytes <= 0) {
+            usage(argv[0]);
+        }
+    }
+
+    glfwInit();
+
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    window = glfwCreateWindow(250, 250, argv[0], NULL, NULL);
+    if (!window) {
+         return EXIT_SKIP;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
+       return EXIT_FAILURE;
+    }
+
+    if (!GLAD_GL_VERSION_4_4) {
+        fprintf(stderr, "error: OpenGL version 4.4 not supported\n");
+        return EXIT_SKIP;
+    }
+
+    init();
+    for (int frame = 0; frame < frames; ++frame) {
+        draw();
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
@@ -0,0 +1,269 @@
+/**************************************************************************
+ *
+ * Copyright 2026 apitrace-tests contributors
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ **************************************************************************/
+
+/*
+ * Draw a window-filling grid from client-side vertex and index arrays, in
+ * bands of rows, each band with a single draw, to exercise the scan of
+ * client index arrays the tracer does to find out how many vertices to
+ * capture:
+ *
+ * - drawelements: glDrawElements, with rows stitched by degenerate
+ *   triangles;
+ *
+ * - drawrangeelements: the same with glDrawRangeElements, giving the exact
+ *   range of vertices of each band;
+ *
+ * - restart: glDrawRangeElements with rows separated by a primitive restart
+ *   index, one past the last vertex, which must not be mistaken for a
+ *   vertex.
+ *
+ * Every row has vertices of its own, coloured orange or blue alternately,
+ * so that the rows come out as solid stripes, while any triangle joining
+ * two rows, as a strip not restarted where it should, blends both colours.
+ *
+ * The time spent in draws is printed at the end.
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+
+static GLFWwindow* window = NULL;
+
+
+enum DrawMethod {
+   DRAW_ELEMENTS,
+   DRAW_RANGE_ELEMENTS,
+   RESTART,
+};
+
+static enum DrawMethod drawMethod = DRAW_RANGE_ELEMENTS;
+
+static int frames = 1;
+
+/* Grid cells per side */
+static int size = 64;
+
+static const int bands = 8;
+
+/* Window size; rows start and end exactly on pixel boundaries for sizes
+ * that divide it */
+static const int windowSize = 256;
+
+
+struct Band {
+   GLuint start;
+   GLuint end;
+   std::vector<GLuint> indices;
+};
+
+static std::vector<GLfloat> vertices;
+static std::vector<GLubyte> colors;
+static std::vector<Band> drawBands;
+static GLuint restartIndex;
+
+
+static void
+usage(const char *name)
+{
+   fprintf(stderr, "usage: %s drawelements|drawrangeelements|restart [FRAMES [SIZE]]\n", name);
+   exit(EXIT_FAILURE);
+}
+
+
+static void
+parseArgs(int argc, char** argv)
+{
+   int i;
+   int numbers = 0;
+
+   for (i = 1; i < argc; ++i) {
+      const char *arg = argv[i];
+      if (strcmp(arg, "drawelements") == 0) {
+         drawMethod = DRAW_ELEMENTS;
+      } else if (strcmp(arg, "drawrangeelements") == 0) {
+         drawMethod = DRAW_RANGE_ELEMENTS;
+      } else if (strcmp(arg, "restart") == 0) {
+         drawMethod = RESTART;
+      } else if (numbers == 0) {
+         frames = atoi(arg);
+         if (frames <= 0) {
+            usage(argv[0]);
+         }
+         ++numbers;
+      } else if (numbers == 1) {
+         size = atoi(arg);
+         if (size <= 0 || size % bands != 0) {
+            fprintf(stderr, "error: size must be a positive multiple of %i\n", bands);
+            exit(EXIT_FAILURE);
+         }
+         ++numbers;
+      } else {
+         usage(argv[0]);
+      }
+   }
+}
+
+
+static void
+createArrays(void)
+{
+   /* Vertices per row, alternately at its bottom and top */
+   const GLuint stride = 2 * (size + 1);
+
+   static const GLubyte rowColors[2][4] = {
+      { 255, 128, 0, 255 },
+      { 0, 0, 255, 255 },
+   };
+
+   vertices.resize(2 * stride * size);
+   colors.resize(4 * stride * size);
+   for (int y = 0; y < size; ++y) {
+      for (GLuint i = 0; i < stride; ++i) {
+         GLuint index = y * stride + i;
+         vertices[2 * index + 0] = 2.0f * (i / 2) / size - 1.0f;
+         vertices[2 * index + 1] = 2.0f * (y + i % 2) / size - 1.0f;
+         memcpy(&colors[4 * index], rowColors[y % 2], 4);
+      }
+   }
+
+   restartIndex = stride * size;
+
+   const int rowsPerBand = size / bands;
+   drawBands.resize(bands);
+   for (int band = 0; band < bands; ++band) {
+      Band &b = drawBands[band];
+      int firstRow = band * rowsPerBand;
+      b.start = firstRow * stride;
+      b.end = (firstRow + rowsPerBand) * stride - 1;
+      for (int y = firstRow; y < firstRow + rowsPerBand; ++y) {
+         if (y != firstRow) {
+            if (drawMethod == RESTART) {
+               b.indices.push_back(restartIndex);
+            } else {
+               /* Degenerate triangles to the start of the next row */
+               b.indices.push_back(b.indices.back());
+               b.indices.push_back(y * stride);
+            }
+         }
+         for (GLuint i = 0; i < stride; ++i) {
+            b.indices.push_back(y * stride + i);
+         }
+      }
+   }
+}
+
+
+static void
+init(void)
+{
+   glClearColor(0.0, 0.0, 0.0, 1.0);
+
+   if (drawMethod == RESTART) {
+      glEnable(GL_PRIMITIVE_RESTART);
+      glPrimitiveRestartIndex(restartIndex);
+   }
+
+   glEnableClientState(GL_VERTEX_ARRAY);
+   glVertexPointer(2, GL_FLOAT, 2 * sizeof(GLfloat), &vertices[0]);
+   glEnableClientState(GL_COLOR_ARRAY);
+   glColorPointer(4, GL_UNSIGNED_BYTE, 4 * sizeof(GLubyte), &colors[0]);
+}
+
+
+static double
+display(void)
+{
+   glClear(GL_COLOR_BUFFER_BIT);
+
+   double start = glfwGetTime();
+
+   for (int band = 0; band < bands; ++band) {
+      const Band &b = drawBands[band];
+      if (drawMethod == DRAW_ELEMENTS) {
+         glDrawElements(GL_TRIANGLE_STRIP, (GLsizei)b.indices.size(), GL_UNSIGNED_INT, &b.indices[0]);
+      } else {
+         glDrawRangeElements(GL_TRIANGLE_STRIP, b.start, b.end, (GLsizei)b.indices.size(), GL_UNSIGNED_INT, &b.indices[0]);
+      }
+   }
+   glFinish();
+
+   double elapsed = glfwGetTime() - start;
+
+   glfwSwapBuffers(window);
+
+   return elapsed;
+}
+
+
+int
+main(int argc, char** argv)
+{
+   parseArgs(argc, argv);
+
+   glfwInit();
+
+   glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+
+   window = glfwCreateWindow(windowSize, windowSize, argv[0], NULL, NULL);
+   if (!window) {
+      return EXIT_SKIP;
+   }
+
+   glfwMakeContextCurrent(window);
+
+   if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
+      return EXIT_FAILURE;
+   }
+
+   if (!GLAD_GL_VERSION_3_1) {
+      fprintf(stderr, "error: OpenGL version 3.1 not supported\n");
+      return EXIT_SKIP;
+   }
+
+   createArrays();
+   init();
+
+   double elapsed = 0.0;
+   for (int frame = 0; frame < frames; ++frame) {
+      elapsed += display();
+   }
+
+   int draws = frames * bands;
+   printf("%i draws in %f secs, %f us per draw\n", draws, elapsed, elapsed * 1e6 / draws);
+   fflush(stdout);
+
+   glfwDestroyWindow(window);
+   glfwTerminate();
+
+   return 0;
+}
@@ -44,15 +44,35 @@ enum MapMethod {
    MAP_BUFFER_ARB,
    MAP_BUFFER_1_5,
    MAP_BUFFER_RANGE,
+   MAP_NAMED_BUFFER_RANGE,
 };
 
 enum MapMethod mapMethod = MAP_BUFFER_ARB;
 
+static bool benchmark = false;
+static int megabytes = 256;
+static int iterations = 100;
+
+/* Ranges written and flushed per map when benchmarking */
+static const int benchmarkRanges = 16;
+static const GLsizeiptr benchmarkRangeSize = 4096;
+
+
+static void
+usage(const char *name)
+{
+   fprintf(stderr, "usage: %s map_buffer_arb|map_buffer_1_5|map_buffer_range|map_named_buffer_range\n"
+                   "       %s map_buffer_range|map_named_buffer_range benchmark [MEGABYTES [ITERATIONS]]\n",
+           name, name);
+   exit(EXIT_FAILURE);
+}
+
 
 static void
 parseArgs(int argc, char** argv)
 {
    int i;
+   int numbers = 0;
 
    for (i = 1; i < argc; ++i) {
       const char *arg = argv[i];
@@ -62,11 +82,33 @@ parseArgs(int argc, char** argv)
          mapMethod = MAP_BUFFER_1_5;
       } else if (strcmp(arg, "map_buffer_range") == 0) {
          mapMethod = MAP_BUFFER_RANGE;
+      } else if (strcmp(arg, "map_named_buffer_range") == 0) {
+         mapMethod = MAP_NAMED_BUFFER_RANGE;
+      } else if (strcmp(arg, "benchmark") == 0) {
+         benchmark = true;
+      } else if (benchmark && numbers == 0) {
+         megabytes = atoi(arg);
+         if (megabytes <= 0) {
+            usage(argv[0]);
+         }
+         ++numbers;
+      } else if (benchmark && numbers == 1) {
+         iterations = atoi(arg);
+         if (iterations <= 0) {
+            usage(argv[0]);
+         }
+         ++numbers;
       } else {
          fprintf(stderr, "error: unexpected arg %s\n", arg);
          exit(1);
       }
    }
+
+   if (benchmark &&
+       mapMethod != MAP_BUFFER_RANGE &&
+       mapMethod != MAP_NAMED_BUFFER_RANGE) {
+      usage(argv[0]);
+   }
 }
 
 
@@ -202,6 +244,131 @@ testMapBufferRange(void)
 }
 
 
+static void
+checkMapNamedBufferRange(void)
+{
+    if (!GLAD_GL_VERSION_4_5 &&
+        !GLAD_GL_ARB_direct_state_access) {
+        fprintf(stderr, "error: GL_ARB_direct_state_access not supported\n");
+        exit(EXIT_SKIP);
+    }
+}
+
+
+static void
+testMapNamedBufferRange(void)
+{
+    GLuint buffers[2];
+    GLvoid *ptr;
+
+    checkMapNamedBufferRange();
+
+    glCreateBuffers(2, buffers);
+
+    glNamedBufferStorage(buffers[0], 1000, NULL, GL_MAP_READ_BIT | GL_MAP_WRITE_BIT);
+
+    ptr = glMapNamedBufferRange(buffers[0], 100, 200, GL_MAP_WRITE_BIT);
+    memset(ptr, 0, 200);
+    glUnmapNamedBuffer(buffers[0]);
+
+    glNamedBufferStorage(buffers[1], 2000, NULL, GL_MAP_READ_BIT | GL_MAP_WRITE_BIT);
+    ptr = glMapNamedBufferRange(buffers[1], 200, 300, GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT);
+    memset(ptr, 0, 300);
+
+    ptr = glMapNamedBufferRange(buffers[0], 100, 200, GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT);
+    memset(ptr, 0, 200);
+
+    glFlushMappedNamedBufferRange(buffers[1], 20, 30);
+    glFlushMappedNamedBufferRange(buffers[1], 40, 50);
+    glUnmapNamedBuffer(buffers[1]);
+
+    glFlushMappedNamedBufferRange(buffers[0], 10, 20);
+    glFlushMappedNamedBufferRange(buffers[0], 30, 40);
+    glUnmapNamedBuffer(buffers[0]);
+
+    glMapNamedBufferRange(buffers[0], 100, 200, GL_MAP_READ_BIT);
+    glUnmapNamedBuffer(buffers[0]);
+
+    glDeleteBuffers(2, buffers);
+}
+
+
+/*
+ * Map the whole of a large buffer over and over, but only write and flush a
+ * few small ranges spread over it each time, so that the time per map
+ * grows with the buffer size only if the mapping is tracked in full.
+ *
+ * Bound and named buffers alike get immutable storage, in a 4.5 core
+ * context, so that only the way of mapping them differs.
+ */
+static void
+benchmarkMapBufferRange(bool named)
+{
+    GLsizeiptr size = (GLsizeiptr)megabytes << 20;
+    GLsizeiptr stride = size / benchmarkRanges;
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
+    GLuint buffer;
+
+    if (named) {
+        checkMapNamedBufferRange();
+        glCreateBuffers(1, &buffer);
+        glNamedBufferStorage(buffer, size, NULL, GL_MAP_WRITE_BIT);
+    } else {
+        if (!GLAD_GL_VERSION_4_4 &&
+            !GLAD_GL_ARB_buffer_storage) {
+            fprintf(stderr, "error: GL_ARB_buffer_storage not supported\n");
+            exit(EXIT_SKIP);
+        }
+        glGenBuffers(1, &buffer);
+        glBindBuffer(target, buffer);
+        glBufferStorage(target, size, NULL, GL_MAP_WRITE_BIT);
+    }
+
+    if (glGetError() == GL_OUT_OF_MEMORY) {
+        fprintf(stderr, "error: could not allocate a %i MB buffer\n", megabytes);
+        exit(EXIT_SKIP);
+    }
+
+    glFinish();
+    double start = glfwGetTime();
+
+    for (int i = 0; i < iterations; ++i) {
+        GLubyte *map;
+        if (named) {
+            map = (GLubyte *)glMapNamedBufferRange(buffer, 0, size, access);
+        } else {
+            map = (GLubyte *)glMapBufferRange(target, 0, size, access);
+        }
+        if (!map) {
+            fprintf(stderr, "error: failed to map a %i MB buffer\n", megabytes);
+            exit(EXIT_FAILURE);
+        }
+        for (int j = 0; j < benchmarkRanges; ++j) {
+            GLintptr offset = j * stride;
+            memset(map + offset, i, benchmarkRangeSize);
+            if (named) {
+                glFlushMappedNamedBufferRange(buffer, offset, benchmarkRangeSize);
+            } else {
+                glFlushMappedBufferRange(target, offset, benchmarkRangeSize);
+            }
+        }
+        if (named) {
+            glUnmapNamedBuffer(buffer);
+        } else {
+            glUnmapBuffer(target);
+        }
+    }
+
+    glFinish();
+    double elapsed = glfwGetTime() - start;
+
+    printf("%i maps in %f secs, %f us per map\n", iterations, elapsed, elapsed * 1e6 / iterations);
+    fflush(stdout);
+
+    glDeleteBuffers(1, &buffer);
+}
+
+
 int main(int argc, char** argv)
 {
     parseArgs(argc, argv);
@@ -217,6 +384,12 @@ int main(int argc, char** argv)
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     }
 #endif
+    if (mapMethod == MAP_NAMED_BUFFER_RANGE || benchmark) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    }
 
     window = glfwCreateWindow(250, 250, argv[0], NULL, NULL);
     if (!window) {
@@ -237,7 +410,18 @@ int main(int argc, char** argv)
         testMapBuffer();
         break;
     case MAP_BUFFER_RANGE:
-        testMapBufferRange();
+        if (benchmark) {
+            benchmarkMapBufferRange(false);
+        } else {
+            testMapBufferRange();
+        }
+        break;
+    case MAP_NAMED_BUFFER_RANGE:
+        if (benchmark) {
+            benchmarkMapBufferRange(true);
+        } else {
+            testMapNamedBufferRange();
+        }
         break;
     }
 
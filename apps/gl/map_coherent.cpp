@@ -51,11 +51,58 @@ static PFNGLNOTIFYMAPPEDBUFFERRANGEVMWXPROC glNotifyMappedBufferRangeVMWX = &noo
 
 static const GLenum target = GL_ARRAY_BUFFER;
 
+static bool dsa = false;
+
+static bool benchmark = false;
+static int megabytes = 256;
+static int iterations = 100;
+
+/* Ranges written per flush when benchmarking */
+static const int benchmarkRanges = 16;
+static const GLsizeiptr benchmarkRangeSize = 4096;
+
 
 static void
-testBufferStorage(void)
+usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [dsa] [benchmark [MEGABYTES [ITERATIONS]]]\n", name);
+    exit(EXIT_FAILURE);
+}
+
+
+static void
+parseArgs(int argc, char** argv)
 {
+    int numbers = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "dsa") == 0) {
+            dsa = true;
+        } else if (strcmp(arg, "benchmark") == 0) {
+            benchmark = true;
+        } else if (benchmark && numbers == 0) {
+            megabytes = atoi(arg);
+            if (megabytes <= 0) {
+                usage(argv[0]);
+            }
+            ++numbers;
+        } else if (benchmark && numbers == 1) {
+            iterations = atoi(arg);
+            if (iterations <= 0) {
+                usage(argv[0]);
+            }
+            ++numbers;
+        } else {
+            usage(argv[0]);
+        }
+    }
+}
 
+
+static GLbitfield
+checkBufferStorage(void)
+{
     if (!GLAD_GL_VERSION_4_4 &&
         !glfwExtensionSupported("GL_ARB_buffer_storage")) {
         fprintf(stderr, "error: GL_ARB_buffer_storage not supported\n");
@@ -63,6 +110,14 @@ testBufferStorage(void)
         exit(EXIT_SKIP);
     }
 
+    if (dsa &&
+        !GLAD_GL_VERSION_4_5 &&
+        !glfwExtensionSupported("GL_ARB_direct_state_access")) {
+        fprintf(stderr, "error: GL_ARB_direct_state_access not supported\n");
+        glfwTerminate();
+        exit(EXIT_SKIP);
+    }
+
     GLbitfield map_trace_explicit_bit = 0;
     if (glfwExtensionSupported("GL_VMWX_map_buffer_debug")) {
         glNotifyMappedBufferRangeVMWX = (PFNGLNOTIFYMAPPEDBUFFERRANGEVMWXPROC)glfwGetProcAddress("glNotifyMappedBufferRangeVMWX");
@@ -70,6 +125,30 @@ testBufferStorage(void)
         map_trace_explicit_bit = GL_MAP_NOTIFY_EXPLICIT_BIT_VMWX;
     }
 
+    return map_trace_explicit_bit;
+}
+
+
+static void
+checkStorageError(void)
+{
+    GLenum error = glGetError();
+    switch (error) {
+    case GL_NO_ERROR:
+        break;
+    case GL_OUT_OF_MEMORY:
+        exit(EXIT_SKIP);
+    default:
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+static void
+testBufferStorage(void)
+{
+    GLbitfield map_trace_explicit_bit = checkBufferStorage();
+
     GLuint buffer = 0;
     glGenBuffers(1, &buffer);
 
@@ -91,15 +170,7 @@ testBufferStorage(void)
 
     free(data);
 
-    GLenum error = glGetError();
-    switch (error) {
-    case GL_NO_ERROR:
-        break;
-    case GL_OUT_OF_MEMORY:
-        exit(EXIT_SKIP);
-    default:
-        exit(EXIT_FAILURE);
-    }
+    checkStorageError();
 
     GLubyte *map;
 
@@ -130,13 +201,141 @@ testBufferStorage(void)
 }
 
 
+static void
+testNamedBufferStorage(void)
+{
+    GLbitfield map_trace_explicit_bit = checkBufferStorage();
+
+    GLuint buffer = 0;
+    glCreateBuffers(1, &buffer);
+
+    GLsizeiptr size = 1000;
+
+    void *data = malloc(size);
+    memset(data, 0, size);
+
+    while ((glGetError() != GL_NO_ERROR))
+        ;
+
+    glNamedBufferStorage(buffer, size, data,
+                         GL_MAP_WRITE_BIT |
+                         GL_MAP_PERSISTENT_BIT |
+                         GL_MAP_COHERENT_BIT |
+                         map_trace_explicit_bit);
+
+    free(data);
+
+    checkStorageError();
+
+    GLubyte *map;
+
+    // straightforward mapping
+    map = (GLubyte *)glMapNamedBufferRange(buffer, 100, 100, GL_MAP_WRITE_BIT);
+    memset(map, 1, 100);
+    glUnmapNamedBuffer(buffer);
+
+    // persistent mapping w/ explicit flush
+    map = (GLubyte *)glMapNamedBufferRange(buffer, 200, 300, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_FLUSH_EXPLICIT_BIT);
+    memset(map + 20, 2, 30);
+    glFlushMappedNamedBufferRange(buffer, 20, 30);
+    memset(map + 50, 3, 50);
+    glFlushMappedNamedBufferRange(buffer, 50, 50);
+    glUnmapNamedBuffer(buffer);
+
+    // persistent & coherent mapping
+    map = (GLubyte *)glMapNamedBufferRange(buffer, 500, 100, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT | map_trace_explicit_bit);
+    memset(map + 20, 4, 30);
+    glNotifyMappedBufferRangeVMWX(map + 20, 30);
+    memset(map + 50, 5, 50);
+    glNotifyMappedBufferRangeVMWX(map + 50, 50);
+    glUnmapNamedBuffer(buffer);
+
+    glDeleteBuffers(1, &buffer);
+}
+
+
+/*
+ * Keep the whole of a large buffer persistently and coherently mapped, and
+ * write a few small ranges spread over it before each glFlush, at which the
+ * tracer must find and capture the writes.  The time per flush grows with
+ * the buffer size only if the whole mapping is scanned for them.
+ *
+ * The buffer is mapped once, bound or named, in a 4.5 core context either
+ * way, so that only the way of mapping it differs.
+ */
+static void
+benchmarkBufferStorage(void)
+{
+    GLbitfield map_trace_explicit_bit = checkBufferStorage();
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT | map_trace_explicit_bit;
+    GLsizeiptr size = (GLsizeiptr)megabytes << 20;
+    GLsizeiptr stride = size / benchmarkRanges;
+
+    while ((glGetError() != GL_NO_ERROR))
+        ;
+
+    GLuint buffer = 0;
+    GLubyte *map;
+    if (dsa) {
+        glCreateBuffers(1, &buffer);
+        glNamedBufferStorage(buffer, size, NULL, flags);
+        checkStorageError();
+        map = (GLubyte *)glMapNamedBufferRange(buffer, 0, size, flags);
+    } else {
+        glGenBuffers(1, &buffer);
+        glBindBuffer(target, buffer);
+        glBufferStorage(target, size, NULL, flags);
+        checkStorageError();
+        map = (GLubyte *)glMapBufferRange(target, 0, size, flags);
+    }
+    if (!map) {
+        fprintf(stderr, "error: failed to map a %i MB buffer\n", megabytes);
+        exit(EXIT_FAILURE);
+    }
+
+    glFinish();
+    double start = glfwGetTime();
+
+    for (int i = 0; i < iterations; ++i) {
+        for (int j = 0; j < benchmarkRanges; ++j) {
+            GLubyte *ptr = map + j * stride;
+            memset(ptr, i, benchmarkRangeSize);
+            glNotifyMappedBufferRangeVMWX(ptr, benchmarkRangeSize);
+        }
+        glFlush();
+    }
+
+    glFinish();
+    double elapsed = glfwGetTime() - start;
+
+    printf("%i flushes in %f secs, %f us per flush\n", iterations, elapsed, elapsed * 1e6 / iterations);
+    fflush(stdout);
+
+    if (dsa) {
+        glUnmapNamedBuffer(buffer);
+    } else {
+        glUnmapBuffer(target);
+        glBindBuffer(target, 0);
+    }
+
+    glDeleteBuffers(1, &buffer);
+}
+
+
 int main(int argc, char** argv)
 {
+    parseArgs(argc, argv);
+
     glfwInit();
 
     glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+    if (dsa || benchmark) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    } else {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+    }
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
@@ -151,7 +350,13 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    testBufferStorage();
+    if (benchmark) {
+        benchmarkBufferStorage();
+    } else if (dsa) {
+        testNamedBufferStorage();
+    } else {
+        testBufferStorage();
+    }
 
     glfwDestroyWindow(window);
     glfwTerminate();
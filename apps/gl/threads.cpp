@@ -0,0 +1,140 @@
+/**************************************************************************
+ *
+ * Copyright 2026 apitrace-tests contributors
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ **************************************************************************/
+
+/*
+ * Clear two windows concurrently from two threads, each with its own
+ * context, to exercise per-thread reference matching.
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+
+#define NUM_THREADS 2
+
+static GLFWwindow* windows[NUM_THREADS];
+
+/* Framebuffer sizes, queried on the main thread as GLFW requires */
+static int widths[NUM_THREADS];
+static int heights[NUM_THREADS];
+
+static int frames = 3;
+
+/* Threads started rendering, so that they get consecutive thread ids in
+ * the trace, in creation order */
+static int started = 0;
+static std::mutex mutex;
+static std::condition_variable cond;
+
+
+static void
+render(int index)
+{
+    GLFWwindow *window = windows[index];
+
+    glfwMakeContextCurrent(window);
+
+    glViewport(0, 0, (GLint) widths[index], (GLint) heights[index]);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        started = index + 1;
+    }
+    cond.notify_all();
+
+    for (int frame = 0; frame < frames; ++frame) {
+        glClearColor(index == 0 ? 1.0f : 0.0f, index == 1 ? 1.0f : 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glfwSwapBuffers(window);
+    }
+
+    glfwMakeContextCurrent(NULL);
+}
+
+
+static void
+usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [FRAMES]\n", name);
+    exit(EXIT_FAILURE);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    if (argc > 2) {
+        usage(argv[0]);
+    }
+    if (argc == 2) {
+        frames = atoi(argv[1]);
+        if (frames <= 0) {
+            usage(argv[0]);
+        }
+    }
+
+    glfwInit();
+
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        windows[i] = glfwCreateWindow(250, 250, argv[0], NULL, NULL);
+        if (!windows[i]) {
+             return EXIT_SKIP;
+        }
+        glfwGetFramebufferSize(windows[i], &widths[i], &heights[i]);
+    }
+
+    glfwMakeContextCurrent(windows[0]);
+    if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
+       return EXIT_FAILURE;
+    }
+    glfwMakeContextCurrent(NULL);
+
+    std::thread threads[NUM_THREADS];
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        threads[i] = std::thread(render, i);
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [i] { return started > i; });
+    }
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        threads[i].join();
+    }
+
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        glfwDestroyWindow(windows[i]);
+    }
+    glfwTerminate();
+
+    return 0;
+}
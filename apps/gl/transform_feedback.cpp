@@ -0,0 +1,329 @@
+/**************************************************************************
+ *
+ * Copyright 2026 apitrace-tests contributors
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ **************************************************************************/
+
+/*
+ * Stream particles through transform feedback with OpenGL 4.0 Core profile,
+ * ping-ponging between two transform feedback objects, and draw them with
+ * glDrawTransformFeedback, for a given number of frames.
+ *
+ * Particles are seeded from gl_VertexID, so no particle data is uploaded,
+ * and move by whole pixels, wrapping around the window, so the resulting
+ * image is exactly predictable.  The first particles are read back and
+ * checked at the end, and the throughput is printed.
+ */
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+
+static GLFWwindow* window;
+
+static int frames = 3;
+static int particles = 1 << 20;
+
+/* Particles read back and checked at the end */
+static const int checked = 64;
+
+static const GLsizei windowSize = 256;
+
+static GLuint updateProgram, renderProgram;
+static GLint u_seed = -1;
+
+static GLuint buffers[2];
+static GLuint feedbacks[2];
+static GLuint emptyVao;
+static GLuint updateVaos[2];
+static GLuint renderVaos[2];
+
+/* Index of the buffer holding the latest particles */
+static int current = 0;
+
+
+static GLuint
+compileShader(GLenum type, const char *text)
+{
+    GLuint shader;
+    GLint stat;
+    char log[1000];
+    GLsizei len;
+
+    shader = glCreateShader(type);
+    glShaderSource(shader, 1, (const char **) &text, NULL);
+    glCompileShader(shader);
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &stat);
+    if (!stat) {
+        glGetShaderInfoLog(shader, sizeof log, &len, log);
+        fprintf(stderr, "error: compiling shader:\n%s\n", log);
+        exit(1);
+    }
+    return shader;
+}
+
+
+static void
+linkProgram(GLuint program)
+{
+    GLint stat;
+    char log[1000];
+    GLsizei len;
+
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &stat);
+    if (!stat) {
+        glGetProgramInfoLog(program, sizeof log, &len, log);
+        fprintf(stderr, "error: linking:\n%s\n", log);
+        exit(1);
+    }
+}
+
+
+static void
+create_shaders(void)
+{
+    static const char *updateShaderText =
+        "#version 400 core\n"
+        "uniform bool seed;\n"
+        "in vec2 pos;\n"
+        "in vec2 vel;\n"
+        "out vec2 outPos;\n"
+        "out vec2 outVel;\n"
+        "void main() {\n"
+        "    vec2 p = pos;\n"
+        "    vec2 v = vel;\n"
+        "    if (seed) {\n"
+        "        int i = gl_VertexID;\n"
+        "        p = vec2(float(i % 64 * 4), float(i / 64 % 64 * 4));\n"
+        "        v = vec2(float(i % 3 - 1), float(i / 3 % 3 - 1));\n"
+        "    }\n"
+        "    outPos = mod(p + v, 256.0);\n"
+        "    outVel = v;\n"
+        "}\n";
+    static const char *renderShaderText =
+        "#version 400 core\n"
+        "in vec2 pos;\n"
+        "void main() {\n"
+        "    gl_Position = vec4((pos + 0.5) / 128.0 - 1.0, 0.0, 1.0);\n"
+        "}\n";
+    static const char *fragShaderText =
+        "#version 400 core\n"
+        "out vec4 f_color;\n"
+        "void main() {\n"
+        "    f_color = vec4(1.0, 1.0, 1.0, 1.0);\n"
+        "}\n";
+    static const char *varyings[] = { "outPos", "outVel" };
+
+    updateProgram = glCreateProgram();
+    glAttachShader(updateProgram, compileShader(GL_VERTEX_SHADER, updateShaderText));
+    glBindAttribLocation(updateProgram, 0, "pos");
+    glBindAttribLocation(updateProgram, 1, "vel");
+    glTransformFeedbackVaryings(updateProgram, 2, varyings, GL_INTERLEAVED_ATTRIBS);
+    linkProgram(updateProgram);
+    u_seed = glGetUniformLocation(updateProgram, "seed");
+
+    renderProgram = glCreateProgram();
+    glAttachShader(renderProgram, compileShader(GL_VERTEX_SHADER, renderShaderText));
+    glAttachShader(renderProgram, compileShader(GL_FRAGMENT_SHADER, fragShaderText));
+    glBindAttribLocation(renderProgram, 0, "pos");
+    glBindFragDataLocation(renderProgram, 0, "f_color");
+    linkProgram(renderProgram);
+}
+
+
+static void
+create_buffers(void)
+{
+    const GLsizei stride = 4 * sizeof(GLfloat);
+
+    glGenBuffers(2, buffers);
+    glGenTransformFeedbacks(2, feedbacks);
+    glGenVertexArrays(1, &emptyVao);
+    glGenVertexArrays(2, updateVaos);
+    glGenVertexArrays(2, renderVaos);
+
+    for (int i = 0; i < 2; ++i) {
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[i]);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)particles * stride, NULL, GL_DYNAMIC_COPY);
+
+        glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, feedbacks[i]);
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffers[i]);
+
+        glBindVertexArray(updateVaos[i]);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void *)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void *)(2 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(1);
+
+        glBindVertexArray(renderVaos[i]);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void *)0);
+        glEnableVertexAttribArray(0);
+    }
+
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+static void
+draw(int frame)
+{
+    int next = 1 - current;
+
+    /* Update the particles */
+    glEnable(GL_RASTERIZER_DISCARD);
+    glUseProgram(updateProgram);
+    glUniform1i(u_seed, frame == 0);
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, feedbacks[next]);
+    glBeginTransformFeedback(GL_POINTS);
+    if (frame == 0) {
+        glBindVertexArray(emptyVao);
+        glDrawArrays(GL_POINTS, 0, particles);
+    } else {
+        glBindVertexArray(updateVaos[current]);
+        glDrawTransformFeedback(GL_POINTS, feedbacks[current]);
+    }
+    glEndTransformFeedback();
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+    glDisable(GL_RASTERIZER_DISCARD);
+
+    /* Draw them */
+    glClear(GL_COLOR_BUFFER_BIT);
+    glUseProgram(renderProgram);
+    glBindVertexArray(renderVaos[next]);
+    glDrawTransformFeedback(GL_POINTS, feedbacks[next]);
+    glBindVertexArray(0);
+
+    glfwSwapBuffers(window);
+
+    current = next;
+}
+
+
+static bool
+check(void)
+{
+    GLfloat data[checked][4];
+    int count = particles < checked ? particles : checked;
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[current]);
+    glGetBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof data[0], data);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    for (int i = 0; i < count; ++i) {
+        float vx = (float)(i % 3 - 1);
+        float vy = (float)(i / 3 % 3 - 1);
+        float x = fmodf((float)(i % 64 * 4) + frames * vx + 256.0f * frames, 256.0f);
+        float y = fmodf((float)(i / 64 % 64 * 4) + frames * vy + 256.0f * frames, 256.0f);
+        if (data[i][0] != x || data[i][1] != y || data[i][2] != vx || data[i][3] != vy) {
+            fprintf(stderr, "error: particle %i is (%g, %g, %g, %g) but should be (%g, %g, %g, %g)\n",
+                    i, data[i][0], data[i][1], data[i][2], data[i][3], x, y, vx, vy);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+static void
+usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [FRAMES [PARTICLES]]\n", name);
+    exit(EXIT_FAILURE);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    if (argc > 3) {
+        usage(argv[0]);
+    }
+    if (argc >= 2) {
+        frames = atoi(argv[1]);
+        if (frames <= 0) {
+            usage(argv[0]);
+        }
+    }
+    if (argc >= 3) {
+        particles = atoi(argv[2]);
+        if (particles <= 0) {
+            usage(argv[0]);
+        }
+    }
+
+    glfwInit();
+
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    window = glfwCreateWindow(windowSize, windowSize, argv[0], NULL, NULL);
+    if (!window) {
+         return EXIT_SKIP;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
+       return EXIT_FAILURE;
+    }
+
+    if (!GLAD_GL_VERSION_4_0) {
+        fprintf(stderr, "error: OpenGL version 4.0 not supported\n");
+        return EXIT_SKIP;
+    }
+
+    glViewport(0, 0, windowSize, windowSize);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+    create_shaders();
+    create_buffers();
+
+    glFinish();
+    double start = glfwGetTime();
+    for (int frame = 0; frame < frames; ++frame) {
+        draw(frame);
+    }
+    glFinish();
+    double elapsed = glfwGetTime() - start;
+
+    printf("%i particles, %i frames in %f secs, %f Mvertices/s\n",
+           particles, frames, elapsed, 2.0 * particles * frames / elapsed * 1e-6);
+    fflush(stdout);
+
+    bool ok = check();
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
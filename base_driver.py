@@ -27,11 +27,17 @@
 '''Common test driver code.'''
 
 
+import atexit
+import cProfile
+import hashlib
+import io
 import optparse
 import os.path
 import platform
+import pstats
 import subprocess
 import sys
+import time
 
 
 # Disable Windows error dialog boxes
@@ -45,7 +51,13 @@ if sys.platform == 'win32':
     del dwMode
 
 
+_start_time = time.perf_counter()
+_exit_status = None
+
+
 def _exit(status, code, reason=None):
+    global _exit_status
+    _exit_status = status
     if reason is None:
         reason = ''
     else:
@@ -81,12 +93,119 @@ def popen(command, *args, **kwargs):
                 sys.stdout.write('%s=%s ' % (name, value))
             env[name] = str(value)
 
+    command = profile_command(command)
+
     sys.stdout.write(' '.join(command) + '\n')
     sys.stdout.flush()
 
     return subprocess.Popen(command, *args, env=env, **kwargs)
 
 
+# apitrace subcommands worth profiling with perf
+_profiled_subcommands = ('trace', 'dump', 'replay', 'retrace')
+
+_perf_records = []
+
+def profile_command(command):
+    '''Wrap an apitrace command in `perf record` when profiling children was
+    requested and perf is available.'''
+
+    if options is None or not options.profile_children:
+        return command
+    if len(command) < 2 or command[0] != options.apitrace or command[1] not in _profiled_subcommands:
+        return command
+    perf = which('perf')
+    if perf is None:
+        return command
+    fileName = os.path.join(options.profile_dir, '%s.%s.%u.perf.data' % (test_name(), command[1], len(_perf_records)))
+    _perf_records.append(fileName)
+    return [perf, 'record', '--quiet', '-g', '-o', fileName, '--'] + command
+
+
+def test_name():
+    '''Name of the test, for the files and records it leaves behind.
+
+    App tests are named after their reference dump, like their ctest names,
+    as several of them may run the same application with different
+    arguments.'''
+    name = os.path.splitext(os.path.basename(sys.argv[0]))[0]
+    ref_dump = getattr(options, 'ref_dump', None)
+    if ref_dump:
+        name += '.%s_%s' % (options.api, os.path.basename(ref_dump).split('.')[0])
+    elif driver_args:
+        name += '.' + os.path.basename(driver_args[0])
+    return name
+
+
+def _write_top(fileName, lines):
+    stream = open(fileName, 'wt')
+    stream.writelines(lines)
+    stream.close()
+    sys.stdout.write('profile: %s\n' % fileName)
+
+
+def _report_profile(profiler):
+    '''Save the driver profile and the perf records of its children, each
+    with a summary of the top hotspots.'''
+
+    name = os.path.join(options.profile_dir, test_name())
+
+    if profiler is not None:
+        profiler.disable()
+        profiler.dump_stats(name + '.prof')
+        stream = io.StringIO()
+        stats = pstats.Stats(profiler, stream=stream)
+        stats.sort_stats('cumulative').print_stats(options.profile_top)
+        stats.sort_stats('tottime').print_stats(options.profile_top)
+        _write_top(name + '.prof.txt', [stream.getvalue()])
+
+    for fileName in _perf_records:
+        if not os.path.exists(fileName):
+            continue
+        p = subprocess.Popen(['perf', 'report', '--stdio', '--no-children', '-g', 'none', '--sort', 'dso,symbol', '-i', fileName],
+                             stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, universal_newlines=True)
+        lines = [line for line in p.stdout if line.strip() and not line.startswith('#')]
+        p.wait()
+        _write_top(os.path.splitext(fileName)[0] + '.txt', lines[:options.profile_top])
+
+
+def _record_history(driver):
+    import history
+
+    driver.recordMetric('total', 'time', time.perf_counter() - _start_time, 's')
+    try:
+        history.record(options.history, test_name(),
+                       history.revision(options.apitrace, options.apitrace_source),
+                       _exit_status or 'ERROR', driver.historyRecords)
+    except Exception as ex:
+        sys.stderr.write('warning: could not record history in %s: %s\n' % (options.history, ex))
+
+
+def start_profile():
+    if not os.path.exists(options.profile_dir):
+        os.makedirs(options.profile_dir)
+    profiler = None
+    if options.profile:
+        profiler = cProfile.Profile()
+    atexit.register(_report_profile, profiler)
+    if profiler is not None:
+        profiler.enable()
+
+
+def digest_lines(lines):
+    '''Return the sha256 hex digest and the number of the given lines, as
+    written in `#sha256 <hex> <lines>` expectations.'''
+
+    digest = hashlib.sha256()
+    numLines = 0
+    for line in lines:
+        if line.endswith('\n'):
+            line = line[:-1]
+        digest.update((line + '\n').encode('utf-8'))
+        numLines += 1
+    return digest.hexdigest(), numLines
+
+
 def which(executable):
     dirs = os.environ['PATH'].split(os.path.pathsep)
     for dir in dirs:
@@ -96,6 +215,10 @@ def which(executable):
     return None
 
 
+options = None
+driver_args = []
+
+
 def get_bin_path():
     if os.path.exists(options.apitrace):
         apitrace_abspath = os.path.abspath(options.apitrace)
@@ -142,7 +265,18 @@ def get_scripts_path():
 class Driver:
 
     def __init__(self):
-        pass
+        self.historyRecords = []
+
+    def recordMetric(self, phase, metric, value, unit, higherIsBetter = False):
+        '''Record a measurement in the performance history, if enabled.'''
+        self.historyRecords.append((phase, metric, value, unit, higherIsBetter))
+
+    def runPhase(self, phase, function, *args):
+        '''Call function, recording how long it took.'''
+        start = time.perf_counter()
+        result = function(*args)
+        self.recordMetric(phase, 'time', time.perf_counter() - start, 's')
+        return result
 
     def createOptParser(self):
         default_apitrace = 'apitrace'
@@ -170,6 +304,28 @@ class Driver:
             '-C', '--directory', metavar='PATH',
             type='string', dest='cwd', default=None,
             help='change to directory')
+        optparser.add_option(
+            '--history', metavar='PATH',
+            type='string', dest='history', default=os.environ.get('APITRACE_TESTS_HISTORY'),
+            help='append timings to this SQLite performance history [default: $APITRACE_TESTS_HISTORY]')
+        optparser.add_option(
+            '--profile',
+            action="store_true",
+            dest="profile", default=False,
+            help="profile the driver with cProfile")
+        optparser.add_option(
+            '--profile-children',
+            action="store_true",
+            dest="profile_children", default=False,
+            help="profile apitrace trace/dump/replay with perf record, where available")
+        optparser.add_option(
+            '--profile-dir', metavar='PATH',
+            type='string', dest='profile_dir', default=None,
+            help='profile output directory [default: results directory, or current directory]')
+        optparser.add_option(
+            '--profile-top', metavar='N',
+            type='int', dest='profile_top', default=30,
+            help='number of hotspots to summarize [default=%default]')
 
         return optparser
 
@@ -186,6 +342,19 @@ class Driver:
         self.options = options
         self.args = args
 
+        global driver_args
+        driver_args = args
+
+        if options.history:
+            options.history = os.path.abspath(options.history)
+            atexit.register(_record_history, self)
+
+        if options.profile or options.profile_children:
+            if options.profile_dir is None:
+                options.profile_dir = getattr(options, 'results', None) or '.'
+            options.profile_dir = os.path.abspath(options.profile_dir)
+            start_profile()
+
         return options, args
 
     def run(self):
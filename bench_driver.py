@@ -0,0 +1,625 @@
+#!/usr/bin/env python3
+##########################################################################
+#
+# Copyright 2026 apitrace-tests contributors
+# All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+#
+##########################################################################/
+
+'''Benchmark driver.'''
+
+
+import gzip
+import json
+import os.path
+import re
+import subprocess
+import sys
+import time
+
+
+from base_driver import *
+import benchmark
+import tracegen
+
+
+def readPnm(stream):
+    '''Parse a stream of concatenated binary PNM images, as written by
+    `apitrace replay --snapshot-prefix=-`, yielding (width, height, data)
+    tuples.'''
+
+    def readToken():
+        token = b''
+        while True:
+            c = stream.read(1)
+            if not c:
+                return token
+            if c == b'#':
+                stream.readline()
+                continue
+            if c.isspace():
+                if token:
+                    return token
+                continue
+            token += c
+
+    while True:
+        magic = readToken()
+        if not magic:
+            return
+        if magic != b'P6':
+            raise ValueError('unsupported PNM image %r' % magic)
+        width = int(readToken())
+        height = int(readToken())
+        maxValue = int(readToken())
+        if maxValue != 255:
+            raise ValueError('unsupported PNM maximum value %u' % maxValue)
+        yield width, height, stream.read(width * height * 3)
+
+
+def rates(amount, timings):
+    return [amount / max(elapsed, 1e-6) for elapsed in timings]
+
+
+class BenchDriver(Driver):
+
+    compressions = [
+        ('snappy', []),
+        ('zlib', ['--zlib']),
+        ('brotli', ['--brotli']),
+    ]
+
+    snapshotFormats = [
+        ('pnm', ['--snapshot-format=PNM']),
+        ('rgb', ['--snapshot-format=RGB']),
+    ]
+
+    threshold_precision = 12.0
+
+    benchmarkRE = re.compile(r'^Rendered (\d+) frames in ([-+.0-9eE]+) secs', re.MULTILINE)
+
+    itemTimeRE = re.compile(r'^(\d+) \w+ in ([-+.0-9eE]+) secs, ([-+.0-9eE]+) us per \w+', re.MULTILINE)
+
+    def __init__(self):
+        Driver.__init__(self)
+        self.measurements = []
+        self.regressions = []
+        self.verdicts = {}
+
+    def runTimed(self, cmd, output = None, **kwargs):
+        '''Run the command, returning the elapsed time in seconds, or None if
+        it failed.  The standard output is written to the output file, if
+        given.'''
+
+        stream = None
+        if output is not None:
+            stream = open(output, 'wb')
+            kwargs['stdout'] = stream
+        start = time.perf_counter()
+        p = popen(cmd, **kwargs)
+        p.wait()
+        elapsed = time.perf_counter() - start
+        if stream is not None:
+            stream.close()
+        if p.returncode != 0:
+            return None
+        return elapsed
+
+    def runRepeated(self, cmd, **kwargs):
+        '''Run the command --warmup times untimed, and then --repeat times,
+        returning the list of elapsed times.'''
+
+        for i in range(self.options.warmup):
+            if self.runTimed(cmd, **kwargs) is None:
+                return None
+        timings = []
+        for i in range(self.options.repeat):
+            elapsed = self.runTimed(cmd, **kwargs)
+            if elapsed is None:
+                return None
+            timings.append(elapsed)
+        return timings
+
+    def report(self, name, metric, samples, unit, higherIsBetter = True):
+        '''Report a measurement, given as a single value or a list of
+        samples, comparing it against the baseline.'''
+
+        if not isinstance(samples, (list, tuple)):
+            samples = [samples]
+        key = '%s/%s' % (name, metric)
+        comparison = self.baseline.check(key, samples, higherIsBetter, self.options.tolerance)
+        value = benchmark.median(samples)
+        sys.stdout.write('%-40s %-20s %10.2f %-5s %s\n' % (name, metric, value, unit, comparison))
+        sys.stdout.flush()
+        self.measurements.append({
+            'name': name,
+            'metric': metric,
+            'value': value,
+            'samples': samples,
+            'unit': unit,
+            'verdict': comparison.verdict,
+            'p': comparison.pValue,
+            'interval': comparison.interval,
+        })
+        self.verdicts[comparison.verdict] = self.verdicts.get(comparison.verdict, 0) + 1
+        self.recordMetric(name, metric, value, unit, higherIsBetter)
+        if comparison.verdict == 'regressed':
+            self.regressions.append(key)
+
+    def pinCpus(self):
+        '''Pin this process, and hence every command it runs, to the --pin-cpus
+        CPUs, returning the CPUs in use.'''
+
+        if not hasattr(os, 'sched_getaffinity'):
+            if self.options.pin_cpus:
+                sys.stderr.write('warning: CPU pinning not supported on this platform\n')
+            return []
+
+        cpus = self.options.pin_cpus
+        if cpus == 'isolated':
+            try:
+                cpus = open('/sys/devices/system/cpu/isolated', 'rt').read().strip()
+            except IOError:
+                cpus = ''
+            if not cpus:
+                sys.stderr.write('warning: no isolated CPUs, not pinning\n')
+        if cpus:
+            cpuSet = set()
+            for item in cpus.split(','):
+                first, sep, last = item.partition('-')
+                cpuSet.update(range(int(first), int(last or first) + 1))
+            os.sched_setaffinity(0, cpuSet)
+            sys.stdout.write('pinned to CPUs %s\n' % ','.join(map(str, sorted(cpuSet))))
+        return sorted(os.sched_getaffinity(0))
+
+    def checkCpuFrequency(self, cpus):
+        '''Check that the CPUs run at a fixed frequency, returning a list of
+        problems found.'''
+
+        def readSys(path):
+            try:
+                return open(path, 'rt').read().strip()
+            except IOError:
+                return None
+
+        problems = []
+        for cpu in cpus:
+            path = '/sys/devices/system/cpu/cpu%u/cpufreq/' % cpu
+            governor = readSys(path + 'scaling_governor')
+            if governor is None:
+                continue
+            if governor != 'performance':
+                problems.append('CPU %u uses the %s governor' % (cpu, governor))
+            minFreq = readSys(path + 'scaling_min_freq')
+            maxFreq = readSys(path + 'scaling_max_freq')
+            if minFreq != maxFreq:
+                problems.append('CPU %u frequency ranges from %s to %s kHz' % (cpu, minFreq, maxFreq))
+        if readSys('/sys/devices/system/cpu/intel_pstate/no_turbo') == '0':
+            problems.append('turbo boost is enabled')
+        if readSys('/sys/devices/system/cpu/cpufreq/boost') == '1':
+            problems.append('frequency boost is enabled')
+        return problems
+
+    def generateTrace(self, name, args):
+        fileName = os.path.join(self.options.results, name + '.trace')
+        tracegen.main(['-o', fileName] + args)
+        return fileName
+
+    def captureTrace(self, name, cmd):
+        '''Trace the given application command, returning None if the
+        application can't run here.'''
+
+        trace = os.path.join(self.options.results, name + '.trace')
+        if os.path.exists(trace):
+            os.remove(trace)
+        p = popen([self.options.apitrace, 'trace', '-o', trace, '--'] + cmd)
+        p.wait()
+        if p.returncode == 125:
+            return None
+        if p.returncode != 0 or not os.path.exists(trace):
+            fail('`apitrace trace` returned code %i' % p.returncode)
+        return trace
+
+    def captureAppTraces(self, apps, args = []):
+        '''Trace each application, leaving out those that can't run here.'''
+
+        traces = []
+        for app in apps:
+            name, ext = os.path.splitext(os.path.basename(app))
+            trace = self.captureTrace(name, [app] + args)
+            if trace is None:
+                sys.stdout.write('%-40s application returned code 125, skipped\n' % name)
+                continue
+            traces.append(trace)
+        return traces
+
+    def supportedCompressions(self):
+        '''Return the compressions `apitrace repack --help` lists, so that
+        only those are measured, and any failure of theirs is an error.'''
+
+        p = popen([self.options.apitrace, 'repack', '--help'], stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        usage, _ = p.communicate()
+        if p.returncode != 0:
+            fail('`apitrace repack --help` returned code %i' % p.returncode)
+
+        compressions = []
+        for compression, args in self.compressions:
+            if all([arg.split('=')[0] in usage for arg in args]):
+                compressions.append((compression, args))
+            else:
+                sys.stdout.write('%-40s %s compression not supported\n' % ('repack', compression))
+        return compressions
+
+    def bench_repack(self, traces):
+        '''Compression ratio and throughput of `apitrace repack`.
+
+        Compression throughput is measured repacking from snappy, whose
+        decompression is cheap; decompression throughput is measured
+        repacking back into snappy, whose compression is cheap.  Throughput
+        is relative to the uncompressed trace size.'''
+
+        results = self.options.results
+
+        compressions = self.supportedCompressions()
+
+        traces = list(traces)
+        traces.append(self.generateTrace('calls', ['--frames=20000', '--draws=4']))
+        traces.append(self.generateTrace('blobs', ['--frames=256', '--blob-size=262144']))
+
+        for trace in traces:
+            name, ext = os.path.splitext(os.path.basename(trace))
+
+            source = os.path.join(results, name + '.snappy.trace')
+            if self.runTimed([self.options.apitrace, 'repack', trace, source]) is None:
+                fail('`apitrace repack` failed on %s' % trace)
+
+            # Obtain the uncompressed size from the gzip stream
+            zlibTrace = os.path.join(results, name + '.zlib.trace')
+            if self.runTimed([self.options.apitrace, 'repack', '--zlib', source, zlibTrace]) is None:
+                fail('`apitrace repack --zlib` failed on %s' % trace)
+            size = 0
+            stream = gzip.open(zlibTrace, 'rb')
+            while True:
+                data = stream.read(1 << 20)
+                if not data:
+                    break
+                size += len(data)
+            stream.close()
+            megabytes = size / float(1 << 20)
+
+            for compression, args in compressions:
+                packed = os.path.join(results, '%s.%s.trace' % (name, compression))
+                compressElapsed = self.runRepeated([self.options.apitrace, 'repack'] + args + [source, packed])
+                if compressElapsed is None:
+                    fail('`apitrace repack %s` failed on %s' % (' '.join(args), trace))
+
+                unpacked = os.path.join(results, '%s.%s.unpacked.trace' % (name, compression))
+                decompressElapsed = self.runRepeated([self.options.apitrace, 'repack', packed, unpacked])
+                if decompressElapsed is None:
+                    fail('`apitrace repack` failed on %s' % packed)
+
+                testName = 'repack/%s/%s' % (name, compression)
+                ratio = float(size) / os.path.getsize(packed)
+                self.report(testName, 'ratio', ratio, 'x')
+                self.report(testName, 'compress', rates(megabytes, compressElapsed), 'MB/s')
+                self.report(testName, 'decompress', rates(megabytes, decompressElapsed), 'MB/s')
+
+    def bench_sed(self, traces):
+        '''Throughput of `apitrace sed` replacing a large shader source in a
+        trace with thousands of large shader sources, relative to the size
+        of the input trace.'''
+
+        results = self.options.results
+
+        search = os.path.join(results, 'sed-search.txt')
+        replace = os.path.join(results, 'sed-replace.txt')
+        trace = self.generateTrace('shaders', [
+            '--threads=4', '--shaders=1000', '--shader-size=16384',
+            '--sed-shader=2500', '--search-file=' + search, '--replace-file=' + replace,
+        ])
+        megabytes = os.path.getsize(trace) / float(1 << 20)
+
+        output = os.path.join(results, 'shaders.sed.trace')
+        elapsed = self.runRepeated([
+            self.options.apitrace, 'sed',
+            '-e', 's|@file(%s)|@file(%s)|' % (search, replace),
+            '-o', output, trace,
+        ])
+        if elapsed is None:
+            fail('`apitrace sed` failed on %s' % trace)
+
+        self.report('sed/shaders', 'throughput', rates(megabytes, elapsed), 'MB/s')
+
+    def bench_replay(self, traces):
+        '''Median frame time of `apitrace replay --benchmark` over the given
+        traces, a synthetic trace, and traces freshly captured from the
+        --app and --loop-app applications.'''
+
+        traces = list(traces)
+        traces.append(self.generateTrace('calls', ['--frames=2000', '--draws=4']))
+        traces += self.captureAppTraces(self.options.apps)
+        traces += self.captureAppTraces(self.options.loop_apps, [str(self.options.frames)])
+
+        for trace in traces:
+            name, ext = os.path.splitext(os.path.basename(trace))
+            cmd = [self.options.apitrace, 'replay', '--benchmark', '--headless', trace]
+            output = os.path.join(self.options.results, name + '.benchmark.txt')
+            frameTimes = []
+            for i in range(self.options.warmup + self.options.repeat):
+                if self.runTimed(cmd, output = output) is None:
+                    fail('`apitrace replay --benchmark` failed on %s' % trace)
+                mo = self.benchmarkRE.search(open(output, 'rt').read())
+                if mo is None:
+                    fail('could not parse `apitrace replay --benchmark` output for %s' % trace)
+                frames, seconds = int(mo.group(1)), float(mo.group(2))
+                if not frames:
+                    break
+                if i >= self.options.warmup:
+                    frameTimes.append(seconds * 1000.0 / frames)
+            if not frameTimes:
+                sys.stdout.write('%-40s no frames rendered\n' % name)
+                continue
+            self.report('replay/' + name, 'frame_time', frameTimes, 'ms', higherIsBetter = False)
+
+    def bench_snapshot(self, args):
+        '''Throughput of snapshotting every frame of a trace of a looping
+        application, with `apitrace dump-images` (PNG files) and with
+        `apitrace replay --snapshot-prefix=-` (PNM or raw RGB streams).  A
+        sample of the PNG snapshots is checked against the PNM ones.'''
+
+        results = self.options.results
+        frames = self.options.frames
+
+        trace = self.captureTrace('loop', args + [str(frames)])
+        if trace is None:
+            skip('application returned code 125')
+
+        replay = [self.options.apitrace, 'replay', '--headless']
+
+        elapsed = self.runRepeated(replay + [trace])
+        if elapsed is None:
+            fail('`apitrace replay` failed on %s' % trace)
+        self.report('snapshot/none', 'fps', rates(frames, elapsed), 'fps')
+
+        pngDir = os.path.join(results, 'png')
+        if not os.path.exists(pngDir):
+            os.makedirs(pngDir)
+        pngPrefix = os.path.join(pngDir, 'loop.')
+        elapsed = self.runRepeated([self.options.apitrace, 'dump-images', '--calls=frame', '-o', pngPrefix, trace])
+        if elapsed is None:
+            fail('`apitrace dump-images` failed on %s' % trace)
+        pngFiles = sorted([os.path.join(pngDir, name) for name in os.listdir(pngDir)
+                           if name.startswith('loop.') and name.endswith('.png')])
+        if len(pngFiles) != frames:
+            fail('expected %u PNG snapshots but got %u' % (frames, len(pngFiles)))
+        size = sum([os.path.getsize(fileName) for fileName in pngFiles])
+        self.report('snapshot/png', 'fps', rates(frames, elapsed), 'fps')
+        self.report('snapshot/png', 'written', size / float(1 << 20), 'MB', higherIsBetter = False)
+
+        for name, formatArgs in self.snapshotFormats:
+            output = os.path.join(results, 'loop.' + name)
+            elapsed = self.runRepeated(replay + ['--snapshot=frame', '--snapshot-prefix=-'] + formatArgs + [trace], output = output)
+            if elapsed is None:
+                fail('`apitrace replay %s` failed on %s' % (' '.join(formatArgs), trace))
+            size = os.path.getsize(output)
+            self.report('snapshot/' + name, 'fps', rates(frames, elapsed), 'fps')
+            self.report('snapshot/' + name, 'written', size / float(1 << 20), 'MB', higherIsBetter = False)
+
+        self.verifySnapshots(pngFiles, os.path.join(results, 'loop.pnm'))
+
+    indexScanModes = ['drawelements', 'drawrangeelements', 'restart']
+    indexScanFrames = 5
+    indexScanSize = 512
+
+    def bench_index_scan(self, args):
+        '''Time per draw of an application drawing from large client index
+        arrays, untraced and traced, with glDrawElements, glDrawRangeElements,
+        and primitive restart, as reported by the application itself.'''
+
+        p = popen(args + ['1', '8'])
+        p.wait()
+        if p.returncode == 125:
+            skip('application returned code %i' % p.returncode)
+
+        trace = os.path.join(self.options.results, 'index_scan.trace')
+        for mode in self.indexScanModes:
+            cmd = args + [mode, str(self.indexScanFrames), str(self.indexScanSize)]
+            untraced = self.itemTimes('index_scan.' + mode, cmd)
+            traced = self.itemTimes('index_scan.%s.traced' % mode, [self.options.apitrace, 'trace', '-o', trace, '--'] + cmd)
+            reference = benchmark.median(untraced)
+            name = 'index_scan/' + mode
+            self.report(name, 'draw_time', traced, 'us', higherIsBetter = False)
+            self.report(name, 'overhead', [value - reference for value in traced], 'us', higherIsBetter = False)
+
+    mapMegabytes = 256
+    mapIterations = 100
+
+    def bench_map(self, args):
+        '''Time per map, or per flush of persistent coherent maps, of large
+        buffers written in a few small ranges, by the map_buffer and
+        map_coherent applications given as arguments, untraced and traced,
+        binding the buffers to a target and with direct state access, as
+        reported by the applications themselves.'''
+
+        if len(args) != 2:
+            fail('expected the map_buffer and map_coherent applications')
+        mapBuffer, mapCoherent = args
+
+        modes = [
+            ('buffer_range', 'map_time', [mapBuffer, 'map_buffer_range']),
+            ('named_buffer_range', 'map_time', [mapBuffer, 'map_named_buffer_range']),
+            ('coherent', 'flush_time', [mapCoherent]),
+            ('coherent_dsa', 'flush_time', [mapCoherent, 'dsa']),
+        ]
+
+        trace = os.path.join(self.options.results, 'map.trace')
+        skipped = 0
+        for mode, metric, cmd in modes:
+            p = popen(cmd + ['benchmark', '1', '1'])
+            p.wait()
+            if p.returncode == 125:
+                sys.stdout.write('%-40s skipped\n' % ('map/' + mode))
+                skipped += 1
+                continue
+            cmd = cmd + ['benchmark', str(self.mapMegabytes), str(self.mapIterations)]
+            untraced = self.itemTimes('map.' + mode, cmd)
+            traced = self.itemTimes('map.%s.traced' % mode, [self.options.apitrace, 'trace', '-o', trace, '--'] + cmd)
+            reference = benchmark.median(untraced)
+            name = 'map/' + mode
+            self.report(name, metric, traced, 'us', higherIsBetter = False)
+            self.report(name, 'overhead', [value - reference for value in traced], 'us', higherIsBetter = False)
+        if skipped == len(modes):
+            skip('applications returned code 125')
+
+    def itemTimes(self, name, cmd):
+        '''Run the command --warmup times and then --repeat times, returning
+        the times per item (draw, map, etc.) it reports.'''
+
+        output = os.path.join(self.options.results, name + '.txt')
+        times = []
+        for i in range(self.options.warmup + self.options.repeat):
+            if self.runTimed(cmd, output = output) is None:
+                fail('`%s` failed' % ' '.join(cmd))
+            mo = self.itemTimeRE.search(open(output, 'rt').read())
+            if mo is None:
+                fail('could not parse the time per item of `%s`' % ' '.join(cmd))
+            if i >= self.options.warmup:
+                times.append(float(mo.group(3)))
+        return times
+
+    def verifySnapshots(self, pngFiles, pnmFileName, samples = 5):
+        try:
+            from PIL import Image
+        except ImportError:
+            sys.stderr.write('warning: PIL not found, skipping snapshot verification\n')
+            return
+        from snapdiff import Comparer
+
+        pnmImages = list(readPnm(open(pnmFileName, 'rb')))
+        if len(pnmImages) != len(pngFiles):
+            fail('expected %u PNM snapshots but got %u' % (len(pngFiles), len(pnmImages)))
+
+        step = max(len(pngFiles) // samples, 1)
+        for index in range(0, len(pngFiles), step):
+            width, height, data = pnmImages[index]
+            pnmImage = Image.frombytes('RGB', (width, height), data)
+            pngImage = Image.open(pngFiles[index])
+            comparer = Comparer(pngImage, pnmImage)
+            precision = comparer.precision(filter=True)
+            sys.stdout.write('snapshot %u: precision of %f bits\n' % (index, precision))
+            if precision < self.threshold_precision:
+                fail('PNG and PNM snapshots %u differ' % index)
+
+    def createOptParser(self):
+        optparser = Driver.createOptParser(self)
+
+        optparser.add_option(
+            '-R', '--results', metavar='PATH',
+            type='string', dest='results', default='.',
+            help='results directory [default=%default]')
+        optparser.add_option(
+            '--baseline-dir', metavar='PATH',
+            type='string', dest='baseline_dir', default='.',
+            help='directory with per-host baseline files [default=%default]')
+        optparser.add_option(
+            '--update-baseline',
+            action="store_true",
+            dest="update_baseline", default=False,
+            help="replace the baseline with the current measurements")
+        optparser.add_option(
+            '--tolerance', metavar='FRACTION',
+            type='float', dest='tolerance', default=0.05,
+            help='smallest relative change against the baseline deemed a regression or improvement [default=%default]')
+        optparser.add_option(
+            '--alpha', metavar='FRACTION',
+            type='float', dest='alpha', default=0.05,
+            help='significance level of the comparison against the baseline [default=%default]')
+        optparser.add_option(
+            '--warmup', metavar='NUMBER',
+            type='int', dest='warmup', default=1,
+            help='number of untimed runs before the measured ones [default=%default]')
+        optparser.add_option(
+            '--repeat', metavar='NUMBER',
+            type='int', dest='repeat', default=5,
+            help='number of measured runs [default=%default]')
+        optparser.add_option(
+            '--pin-cpus', metavar='LIST',
+            type='string', dest='pin_cpus', default=None,
+            help='pin to the given CPUs, e.g. 2-3,6, or to the kernel\'s isolated CPUs with "isolated"')
+        optparser.add_option(
+            '--require-fixed-frequency',
+            action="store_true",
+            dest="require_fixed_frequency", default=False,
+            help="skip unless the CPUs run at a fixed frequency")
+        optparser.add_option(
+            '--frames', metavar='NUMBER',
+            type='int', dest='frames', default=300,
+            help='frames rendered by looping applications [default=%default]')
+        optparser.add_option(
+            '--app', metavar='PROGRAM',
+            type='string', dest='apps', action='append', default=[],
+            help='application to capture a trace from')
+        optparser.add_option(
+            '--loop-app', metavar='PROGRAM',
+            type='string', dest='loop_apps', action='append', default=[],
+            help='application to capture a trace from, rendering --frames frames')
+
+        return optparser
+
+    def run(self):
+        (options, args) = self.parseOptions()
+
+        if not os.path.exists(options.results):
+            os.makedirs(options.results)
+
+        name = args[0]
+        try:
+            bench = getattr(self, 'bench_' + name)
+        except AttributeError:
+            fail('unknown benchmark %s' % name)
+
+        cpus = self.pinCpus()
+        problems = self.checkCpuFrequency(cpus)
+        for problem in problems:
+            sys.stderr.write('warning: %s\n' % problem)
+        if problems and options.require_fixed_frequency:
+            skip('CPU frequency is not fixed')
+
+        self.baseline = benchmark.Baseline(options.baseline_dir, options.update_baseline, options.alpha)
+
+        bench(args[1:])
+
+        stream = open(os.path.join(options.results, name + '.json'), 'wt')
+        json.dump(self.measurements, stream, sort_keys=True, indent=2)
+        stream.close()
+
+        verdicts = ', '.join(['%u %s' % (self.verdicts[verdict], verdict) for verdict in sorted(self.verdicts)])
+
+        if self.regressions:
+            fail('%s: %s' % (verdicts, ', '.join(self.regressions)))
+
+        self.baseline.save()
+
+        pass_(verdicts)
+
+
+if __name__ == '__main__':
+    BenchDriver().run()
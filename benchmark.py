@@ -0,0 +1,230 @@
+##########################################################################
+#
+# Copyright 2026 apitrace-tests contributors
+# All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+#
+##########################################################################/
+
+'''Common benchmark code.'''
+
+
+import json
+import math
+import os.path
+import platform
+import statistics
+
+
+def median(values):
+    values = sorted(values)
+    count = len(values)
+    if not count:
+        return None
+    middle = count // 2
+    if count % 2:
+        return values[middle]
+    return 0.5 * (values[middle - 1] + values[middle])
+
+
+def _ranks(values):
+    '''Ranks of the values, averaging ties, plus the tie correction term.'''
+    order = sorted(range(len(values)), key=lambda i: values[i])
+    ranks = [0.0] * len(values)
+    ties = 0
+    i = 0
+    while i < len(order):
+        j = i
+        while j + 1 < len(order) and values[order[j + 1]] == values[order[i]]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[order[k]] = 0.5 * (i + j) + 1.0
+        t = j - i + 1
+        ties += t * t * t - t
+        i = j + 1
+    return ranks, ties
+
+
+def _exactCounts(m, n):
+    '''Number of arrangements of m + n untied samples yielding each value
+    of the U statistic of the first sample.'''
+    # counts[j][u] for the first sample of size i (built up) and second of size j
+    counts = [[1] for j in range(n + 1)]
+    for i in range(1, m + 1):
+        row = [[1]]
+        for j in range(1, n + 1):
+            left = row[j - 1]
+            up = counts[j]
+            size = i * j + 1
+            cur = [0] * size
+            for u, c in enumerate(left):
+                cur[u] += c
+            for u, c in enumerate(up):
+                cur[u + j] += c
+            row.append(cur)
+        counts = row
+    return counts[n]
+
+
+# Largest sample sizes for which exact p-values are computed
+exactLimit = 20
+
+
+def mannWhitneyU(xs, ys):
+    '''Two-sided Mann-Whitney U test, returning the U statistic of xs and
+    the p-value of xs and ys coming from the same distribution.'''
+
+    m, n = len(xs), len(ys)
+    ranks, ties = _ranks(list(xs) + list(ys))
+    u = sum(ranks[:m]) - m * (m + 1) / 2.0
+
+    if not ties and m <= exactLimit and n <= exactLimit:
+        counts = _exactCounts(m, n)
+        total = float(sum(counts))
+        k = int(round(u))
+        lower = sum(counts[:k + 1]) / total
+        upper = sum(counts[k:]) / total
+        return u, min(1.0, 2.0 * min(lower, upper))
+
+    total = m + n
+    variance = m * n / 12.0 * ((total + 1) - ties / float(total * (total - 1)))
+    if variance <= 0:
+        return u, 1.0
+    delta = abs(u - m * n / 2.0) - 0.5
+    if delta <= 0:
+        return u, 1.0
+    z = delta / math.sqrt(variance)
+    return u, min(1.0, math.erfc(z / math.sqrt(2.0)))
+
+
+def shiftInterval(xs, ys, confidence = 0.95):
+    '''Hodges-Lehmann estimate of the shift of xs relative to ys, with its
+    confidence interval, as a (low, estimate, high) tuple.'''
+
+    m, n = len(xs), len(ys)
+    differences = sorted([x - y for x in xs for y in ys])
+    count = len(differences)
+    z = statistics.NormalDist().inv_cdf(0.5 + 0.5 * confidence)
+    k = int(math.floor(m * n / 2.0 - z * math.sqrt(m * n * (m + n + 1) / 12.0)))
+    k = min(max(k, 0), (count - 1) // 2)
+    return differences[k], median(differences), differences[count - 1 - k]
+
+
+class Comparison:
+    '''Outcome of comparing a set of measurements against the baseline.'''
+
+    def __init__(self, verdict, refValue = None, pValue = None, interval = None):
+        self.verdict = verdict
+        self.refValue = refValue
+        self.pValue = pValue
+        # Relative (low, estimate, high) shift against the baseline
+        self.interval = interval
+
+    def __str__(self):
+        if self.refValue is None:
+            return self.verdict
+        s = '%s (baseline %.2f' % (self.verdict, self.refValue)
+        if self.interval is not None:
+            low, estimate, high = [100.0 * value for value in self.interval]
+            s += ', %+.1f%% [%+.1f%%, %+.1f%%]' % (estimate, low, high)
+        if self.pValue is not None:
+            s += ', p=%.3f' % self.pValue
+        return s + ')'
+
+
+class Baseline:
+    '''Reference measurements for this host, kept as a JSON file named after
+    the host, so that measurements are only compared against measurements
+    from the same machine.
+
+    Every measurement is a list of samples.  When both the baseline and the
+    new measurement have enough samples they are compared with a
+    Mann-Whitney U test, and only a significant shift larger than the
+    tolerance is a regression or an improvement; otherwise their medians
+    are compared against the tolerance.'''
+
+    # Fewer samples can't reach significance at the usual levels
+    minSamples = 4
+
+    def __init__(self, dirName, update = False, alpha = 0.05):
+        host = platform.node() or 'localhost'
+        self.fileName = os.path.join(dirName, host + '.json')
+        self.update = update
+        self.alpha = alpha
+        self.values = {}
+        self.dirty = False
+        if os.path.exists(self.fileName):
+            self.values = json.load(open(self.fileName, 'rt'))
+
+    def check(self, key, samples, higherIsBetter, tolerance):
+        '''Compare samples against the reference, and return a Comparison,
+        whose verdict is one of 'new', 'ok', 'improved', or 'regressed'.'''
+
+        if not isinstance(samples, (list, tuple)):
+            samples = [samples]
+
+        try:
+            refSamples = self.values[key]
+        except KeyError:
+            refSamples = None
+        if refSamples is not None and not isinstance(refSamples, list):
+            refSamples = [refSamples]
+
+        if not refSamples or self.update:
+            self.values[key] = list(samples)
+            self.dirty = True
+            if refSamples:
+                return Comparison('new', median(refSamples))
+            return Comparison('new')
+
+        value = median(samples)
+        refValue = median(refSamples)
+        scale = abs(refValue) or 1.0
+        sign = 1.0 if higherIsBetter else -1.0
+
+        pValue = None
+        interval = None
+        if len(samples) >= self.minSamples and len(refSamples) >= self.minSamples:
+            u, pValue = mannWhitneyU(samples, refSamples)
+            interval = tuple([shift / scale for shift in shiftInterval(samples, refSamples, 1.0 - self.alpha)])
+            significant = pValue < self.alpha
+            shift = interval[1]
+        else:
+            significant = True
+            shift = (value - refValue) / scale
+
+        if significant and sign * shift < -tolerance:
+            verdict = 'regressed'
+        elif significant and sign * shift > tolerance:
+            verdict = 'improved'
+        else:
+            verdict = 'ok'
+        return Comparison(verdict, refValue, pValue, interval)
+
+    def save(self):
+        if not self.dirty:
+            return
+        dirName = os.path.dirname(self.fileName)
+        if dirName and not os.path.exists(dirName):
+            os.makedirs(dirName)
+        stream = open(self.fileName, 'wt')
+        json.dump(self.values, stream, sort_keys=True, indent=2)
+        stream.write('\n')
+        stream.close()
@@ -24,24 +24,78 @@
 
 '''Test driver for scripts in the cli directory.'''
 
+import io
 import json
 import errno
 import shutil
+import re
 import subprocess
 import difflib
+import tempfile
+import threading
+import time
 
 from base_driver import *
+import imagegen
+import tracegen
 
 class CliDriver(Driver):
 
+    def __init__(self):
+        Driver.__init__(self)
+        self.output = ''
+        self.elapsed = 0.0
+        self.maxrss = None
+        self.timeout = None
+        self.records = {}
+
     def do_apitrace(self, args):
-        cmd = [self.options.apitrace] + args.split()
+        cmd = profile_command([self.options.apitrace] + args.split())
  
         print(" ".join(cmd))
-        proc = subprocess.Popen(cmd, stdout = subprocess.PIPE, universal_newlines=True)
-        self.output = proc.communicate()[0]
-
-        proc.wait()
+        self.maxrss = None
+        start = time.perf_counter()
+        if hasattr(os, 'wait4'):
+            # Spool the output into a file and reap the process ourselves,
+            # so that its peak resident set size can be measured.
+            stdout = tempfile.TemporaryFile('w+t')
+            proc = subprocess.Popen(cmd, stdout = stdout, universal_newlines=True)
+            timedOut = []
+            def kill():
+                timedOut.append(True)
+                proc.kill()
+            timer = None
+            if self.timeout is not None:
+                timer = threading.Timer(self.timeout, kill)
+                timer.start()
+            pid, status, rusage = os.wait4(proc.pid, 0)
+            self.elapsed = time.perf_counter() - start
+            if timer is not None:
+                timer.cancel()
+            if os.WIFSIGNALED(status):
+                proc.returncode = -os.WTERMSIG(status)
+            else:
+                proc.returncode = os.WEXITSTATUS(status)
+            if timedOut:
+                fail("Command timed out after %s seconds:\n    %s" % (self.timeout, " ".join(cmd)))
+            # ru_maxrss is in kilobytes on Linux, but in bytes on MacOSX
+            if sys.platform == 'darwin':
+                self.maxrss = rusage.ru_maxrss / (1024.0 * 1024.0)
+            else:
+                self.maxrss = rusage.ru_maxrss / 1024.0
+            stdout.seek(0)
+            self.output = stdout.read()
+            stdout.close()
+        else:
+            proc = subprocess.Popen(cmd, stdout = subprocess.PIPE, universal_newlines=True)
+            try:
+                self.output = proc.communicate(timeout = self.timeout)[0]
+            except subprocess.TimeoutExpired:
+                proc.kill()
+                proc.communicate()
+                fail("Command timed out after %s seconds:\n    %s" % (self.timeout, " ".join(cmd)))
+            proc.wait()
+            self.elapsed = time.perf_counter() - start
 
         if (self.expect_failure):
             if (proc.returncode == 0):
@@ -50,6 +104,80 @@ class CliDriver(Driver):
             if (proc.returncode != 0):
                 fail("Command failed (returned non-zero):\n    " + " ".join(cmd))
 
+    def do_diff_images_parallel(self, args):
+        '''Like `apitrace diff-images`, but comparing disjoint subsets of the
+        images concurrently, one per CPU.'''
+
+        args = args.split()
+        options, refPrefix, srcPrefix = args[:-2], args[-2], args[-1]
+        if not refPrefix.endswith('/') or not srcPrefix.endswith('/'):
+            fail('Broken test script: diff_images_parallel expects directories ending in /')
+
+        names = sorted([name for name in os.listdir(refPrefix) if name.endswith('.png')])
+        jobs = max(min(os.cpu_count() or 1, len(names)), 1)
+
+        # Split the images into shard directories of links to the originals
+        shardDir = tempfile.mkdtemp(prefix='diff-images-', dir='.')
+        shards = []
+        for shard in range(jobs):
+            shardRef = os.path.join(shardDir, '%u-ref' % shard) + '/'
+            shardSrc = os.path.join(shardDir, '%u-src' % shard) + '/'
+            os.mkdir(shardRef)
+            os.mkdir(shardSrc)
+            for name in names[shard::jobs]:
+                for prefix, shardPrefix in ((refPrefix, shardRef), (srcPrefix, shardSrc)):
+                    if not os.path.exists(prefix + name):
+                        continue
+                    try:
+                        os.link(prefix + name, shardPrefix + name)
+                    except OSError:
+                        shutil.copyfile(prefix + name, shardPrefix + name)
+            shards.append((shardRef, shardSrc))
+
+        cmds = [[self.options.apitrace, 'diff-images'] + options + [shardRef, shardSrc]
+                for shardRef, shardSrc in shards]
+        print("%u x %s" % (jobs, " ".join([self.options.apitrace, 'diff-images'] + args)))
+
+        self.maxrss = None
+        start = time.perf_counter()
+        procs = []
+        for cmd in cmds:
+            stdout = tempfile.TemporaryFile('w+t')
+            procs.append((subprocess.Popen(cmd, stdout = stdout, universal_newlines=True), stdout))
+        returncode = 0
+        for proc, stdout in procs:
+            try:
+                remaining = None
+                if self.timeout is not None:
+                    remaining = max(self.timeout - (time.perf_counter() - start), 0)
+                proc.wait(timeout = remaining)
+            except subprocess.TimeoutExpired:
+                for proc, stdout in procs:
+                    proc.kill()
+                    proc.wait()
+                fail("Command timed out after %s seconds:\n    %s" % (self.timeout, " ".join(cmds[0])))
+            returncode = returncode or proc.returncode
+        self.elapsed = time.perf_counter() - start
+
+        # Map the shard directories back to the original ones, only where a
+        # path starts, i.e., at the start of a line or after a space
+        output = []
+        for (proc, stdout), (shardRef, shardSrc) in zip(procs, shards):
+            prefixes = {shardRef: refPrefix, shardSrc: srcPrefix}
+            shard_re = re.compile(r'(^|\s)(%s|%s)' % (re.escape(shardRef), re.escape(shardSrc)), re.MULTILINE)
+            stdout.seek(0)
+            output.append(shard_re.sub(lambda mo: mo.group(1) + prefixes[mo.group(2)], stdout.read()))
+            stdout.close()
+        self.output = ''.join(output)
+        shutil.rmtree(shardDir)
+
+        if (self.expect_failure):
+            if (returncode == 0):
+                fail("Command unexpectedly passed when expecting failure:\n    " + " ".join(cmds[0]))
+        else:
+            if (returncode != 0):
+                fail("Command failed (returned non-zero):\n    " + " ".join(cmds[0]))
+
     def do_expect(self, args):
         expected = eval(args)
         if (self.output != expected):
@@ -58,6 +186,83 @@ class CliDriver(Driver):
             diff = ''.join(diff)
             fail("Unexpected output:\n%s\n" % diff)
 
+    def do_imagegen(self, args):
+        imagegen.main(args.split())
+
+    def do_sort(self, args):
+        self.output = ''.join(sorted(io.StringIO(self.output).readlines()))
+
+    def do_tracegen(self, args):
+        tracegen.main(args.split())
+
+    def do_timeout(self, args):
+        self.timeout = float(args)
+
+    def do_expect_sha256(self, args):
+        args = args.split()
+        if len(args) != 2:
+            fail('Broken test script: expect_sha256 <hex> <lines>')
+        refDigest, refNumLines = args[0].lower(), int(args[1])
+        srcDigest, srcNumLines = digest_lines(io.StringIO(self.output))
+        if (srcNumLines != refNumLines):
+            fail("Unexpected output: expected %u lines but got %u" % (refNumLines, srcNumLines))
+        if (srcDigest != refDigest):
+            fail("Unexpected output: expected sha256 %s but got %s" % (refDigest, srcDigest))
+
+    def do_grep(self, args):
+        pattern = re.compile(args.strip())
+        lines = io.StringIO(self.output).readlines()
+        self.output = ''.join([line for line in lines if pattern.search(line)])
+
+    def do_sub(self, args):
+        args = args.split()
+        if len(args) != 2:
+            fail('Broken test script: sub <pattern> <replacement>')
+        pattern = re.compile(args[0])
+        lines = io.StringIO(self.output).readlines()
+        self.output = ''.join([pattern.sub(args[1], line) for line in lines])
+
+    def do_expect_calls(self, args):
+        refNumCalls = int(args)
+        srcNumCalls = len([line for line in io.StringIO(self.output) if line.strip()])
+        if (srcNumCalls != refNumCalls):
+            fail("Unexpected output: expected %u calls but got %u" % (refNumCalls, srcNumCalls))
+
+    def do_record(self, args):
+        name = args.strip()
+        self.records[name] = (digest_lines(io.StringIO(self.output)), self.elapsed, self.maxrss)
+        self.recordMetric(name, 'time', self.elapsed, 's')
+        if self.maxrss is not None:
+            self.recordMetric(name, 'maxrss', self.maxrss, 'MiB')
+        if self.maxrss is None:
+            print("%s: %.3f seconds" % (name, self.elapsed))
+        else:
+            print("%s: %.3f seconds, %.1f MiB peak RSS" % (name, self.elapsed, self.maxrss))
+
+    def do_expect_same(self, args):
+        name = args.strip()
+        try:
+            expected, elapsed, maxrss = self.records[name]
+        except KeyError:
+            fail('Broken test script: Unknown record: %s' % (name))
+        if (digest_lines(io.StringIO(self.output)) != expected):
+            fail("Output differs from %s" % (name))
+
+    def do_expect_time(self, args):
+        timings = dict([(name, elapsed) for name, (digest, elapsed, maxrss) in self.records.items()])
+        if not eval(args, {'cpus': os.cpu_count() or 1}, timings):
+            fail("Timing expectation not met: %s\n%s" % (args,
+                 ''.join(["    %s = %.3f\n" % item for item in sorted(timings.items())])))
+
+    def do_expect_rss(self, args):
+        usages = dict([(name, maxrss) for name, (digest, elapsed, maxrss) in self.records.items()])
+        if None in usages.values():
+            print("Peak RSS not available on this platform; skipping: %s" % (args))
+            return
+        if not eval(args, {}, usages):
+            fail("Memory expectation not met: %s\n%s" % (args,
+                 ''.join(["    %s = %.1f MiB\n" % item for item in sorted(usages.items())])))
+
     def do_rm_and_mkdir(self, args):
 
         args = args.split()
@@ -84,8 +289,21 @@ class CliDriver(Driver):
 
         commands = {
             'apitrace': self.do_apitrace,
+            'diff_images_parallel': self.do_diff_images_parallel,
             'expect': self.do_expect,
-            'rm_and_mkdir': self.do_rm_and_mkdir
+            'expect_calls': self.do_expect_calls,
+            'expect_same': self.do_expect_same,
+            'expect_sha256': self.do_expect_sha256,
+            'expect_rss': self.do_expect_rss,
+            'expect_time': self.do_expect_time,
+            'grep': self.do_grep,
+            'imagegen': self.do_imagegen,
+            'record': self.do_record,
+            'rm_and_mkdir': self.do_rm_and_mkdir,
+            'sort': self.do_sort,
+            'sub': self.do_sub,
+            'timeout': self.do_timeout,
+            'tracegen': self.do_tracegen,
         }
 
         script = open(cli_script, 'rt')
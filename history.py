@@ -0,0 +1,294 @@
+#!/usr/bin/env python3
+##########################################################################
+#
+# Copyright 2026 apitrace-tests contributors
+# All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+#
+##########################################################################/
+
+'''Performance history of the test suite, kept in a SQLite database, and
+reports of its trends.'''
+
+
+import html
+import optparse
+import os.path
+import platform
+import sqlite3
+import subprocess
+import sys
+import time
+
+import benchmark
+
+
+_schema = '''
+CREATE TABLE IF NOT EXISTS runs (
+    id INTEGER PRIMARY KEY,
+    time REAL,
+    host TEXT,
+    revision TEXT,
+    test TEXT,
+    status TEXT
+);
+CREATE TABLE IF NOT EXISTS measurements (
+    run INTEGER REFERENCES runs(id),
+    phase TEXT,
+    metric TEXT,
+    value REAL,
+    unit TEXT,
+    higher_is_better INTEGER
+);
+CREATE INDEX IF NOT EXISTS runs_host_test ON runs(host, test);
+'''
+
+
+def connect(fileName):
+    dirName = os.path.dirname(fileName)
+    if dirName and not os.path.exists(dirName):
+        os.makedirs(dirName)
+    # Tests run in parallel may write at the same time
+    db = sqlite3.connect(fileName, timeout=60)
+    db.executescript(_schema)
+    return db
+
+
+def revision(apitrace, sourceDir = None):
+    '''Identify the apitrace build under test, by the git revision of its
+    source or build tree, or failing that by its version.'''
+
+    try:
+        return os.environ['APITRACE_REVISION']
+    except KeyError:
+        pass
+
+    dirNames = []
+    if sourceDir:
+        dirNames.append(sourceDir)
+    if os.path.exists(apitrace):
+        dirNames.append(os.path.dirname(os.path.realpath(apitrace)))
+    for dirName in dirNames:
+        try:
+            output = subprocess.check_output(['git', '-C', dirName, 'rev-parse', '--short=12', 'HEAD'],
+                                             stderr=subprocess.DEVNULL, universal_newlines=True)
+        except (OSError, subprocess.CalledProcessError):
+            continue
+        return output.strip()
+
+    try:
+        output = subprocess.check_output([apitrace, 'version'], stderr=subprocess.DEVNULL, universal_newlines=True)
+    except (OSError, subprocess.CalledProcessError):
+        return 'unknown'
+    return output.strip() or 'unknown'
+
+
+def record(fileName, test, revision, status, measurements):
+    '''Append a test run, with its (phase, metric, value, unit,
+    higherIsBetter) measurements.'''
+
+    db = connect(fileName)
+    with db:
+        cursor = db.execute('INSERT INTO runs (time, host, revision, test, status) VALUES (?, ?, ?, ?, ?)',
+                            (time.time(), platform.node() or 'localhost', revision, test, status))
+        run = cursor.lastrowid
+        db.executemany('INSERT INTO measurements (run, phase, metric, value, unit, higher_is_better) VALUES (?, ?, ?, ?, ?, ?)',
+                       [(run, phase, metric, value, unit, int(higherIsBetter))
+                        for phase, metric, value, unit, higherIsBetter in measurements])
+    db.close()
+
+
+class Trend:
+
+    def __init__(self, test, phase, metric, unit, value, refValue, higherIsBetter):
+        self.test = test
+        self.phase = phase
+        self.metric = metric
+        self.unit = unit
+        self.value = value
+        self.refValue = refValue
+        if refValue:
+            self.change = (value - refValue) / abs(refValue)
+        else:
+            self.change = 0.0
+        self.higherIsBetter = higherIsBetter
+
+    def verdict(self, threshold):
+        change = self.change if self.higherIsBetter else -self.change
+        if change < -threshold:
+            return 'regressed'
+        if change > threshold:
+            return 'improved'
+        return 'ok'
+
+
+def trends(db, host, revision = None, runs = 5):
+    '''Compare every measurement of the latest run of each test at the given
+    revision (by default the latest one) against the median over the
+    previous runs runs of that test, whatever their revision, returning
+    (revision, previousRevisions, trends).'''
+
+    rows = db.execute('SELECT revision, MAX(time) FROM runs WHERE host = ? GROUP BY revision ORDER BY MAX(time)', (host,)).fetchall()
+    revisions = [row[0] for row in rows]
+    if not revisions:
+        return None, [], []
+    if revision is None:
+        revision = revisions[-1]
+    elif revision not in revisions:
+        raise ValueError('no runs of revision %s on %s' % (revision, host))
+
+    # Passed runs of each test, oldest first
+    testRuns = {}
+    for run, test, revision_ in db.execute(
+        'SELECT id, test, revision FROM runs WHERE host = ? AND status = ? ORDER BY time, id', (host, 'PASS')):
+        testRuns.setdefault(test, []).append((run, revision_))
+
+    current = {}
+    previous = {}
+    previousRevisions = set()
+    for test, testRunList in testRuns.items():
+        indices = [index for index, (run, revision_) in enumerate(testRunList) if revision_ == revision]
+        if not indices:
+            continue
+        index = indices[-1]
+        current[testRunList[index][0]] = test
+        for run, revision_ in testRunList[max(index - runs, 0):index]:
+            previous[run] = test
+            previousRevisions.add(revision_)
+
+    series = {}
+    for run, phase, metric, value, unit, higherIsBetter in db.execute(
+        'SELECT measurements.run, phase, metric, value, unit, higher_is_better '
+        'FROM measurements JOIN runs ON measurements.run = runs.id '
+        'WHERE runs.host = ? AND runs.status = ?', (host, 'PASS')):
+        if run in current:
+            test = current[run]
+        elif run in previous:
+            test = previous[run]
+        else:
+            continue
+        key = (test, phase, metric)
+        try:
+            entry = series[key]
+        except KeyError:
+            entry = series[key] = (unit, bool(higherIsBetter), [], [])
+        if run in current:
+            entry[2].append(value)
+        else:
+            entry[3].append(value)
+
+    result = []
+    for key in sorted(series):
+        unit, higherIsBetter, values, refValues = series[key]
+        if not values or not refValues:
+            continue
+        test, phase, metric = key
+        result.append(Trend(test, phase, metric, unit, benchmark.median(values), benchmark.median(refValues), higherIsBetter))
+    previousRevisions = [revision_ for revision_ in revisions if revision_ in previousRevisions]
+    return revision, previousRevisions, result
+
+
+def writeText(stream, revision, previous, trends, threshold, all = False):
+    stream.write('revision %s against previous runs at %s\n' % (revision, ', '.join(previous) or 'nothing'))
+    for verdict in ('regressed', 'improved'):
+        selected = [trend for trend in trends if trend.verdict(threshold) == verdict]
+        stream.write('\n%u %s:\n' % (len(selected), verdict))
+        for trend in sorted(selected, key=lambda trend: -abs(trend.change)):
+            stream.write('  %-40s %-12s %-10s %10.3f %-5s %+7.1f%% (was %.3f)\n' % (
+                trend.test, trend.phase, trend.metric, trend.value, trend.unit, 100.0 * trend.change, trend.refValue))
+    if all:
+        selected = [trend for trend in trends if trend.verdict(threshold) == 'ok']
+        stream.write('\n%u unchanged:\n' % len(selected))
+        for trend in selected:
+            stream.write('  %-40s %-12s %-10s %10.3f %-5s %+7.1f%%\n' % (
+                trend.test, trend.phase, trend.metric, trend.value, trend.unit, 100.0 * trend.change))
+
+
+def writeHtml(stream, revision, previous, trends, threshold):
+    colors = {'regressed': '#f8d0d0', 'improved': '#d0f0d0', 'ok': '#ffffff'}
+    stream.write('<!DOCTYPE html>\n<html>\n<head><meta charset="utf-8"><title>apitrace performance history</title></head>\n<body>\n')
+    stream.write('<h1>Revision %s</h1>\n<p>Against previous runs at %s.</p>\n' % (html.escape(revision), html.escape(', '.join(previous) or 'nothing')))
+    stream.write('<table border="1" cellspacing="0" cellpadding="2">\n')
+    stream.write('<tr><th>Test</th><th>Phase</th><th>Metric</th><th>Value</th><th>Previous</th><th>Change</th><th>Verdict</th></tr>\n')
+    order = {'regressed': 0, 'improved': 1, 'ok': 2}
+    for trend in sorted(trends, key=lambda trend: (order[trend.verdict(threshold)], -abs(trend.change))):
+        verdict = trend.verdict(threshold)
+        stream.write('<tr style="background-color: %s"><td>%s</td><td>%s</td><td>%s</td><td>%.3f %s</td><td>%.3f %s</td><td>%+.1f%%</td><td>%s</td></tr>\n' % (
+            colors[verdict], html.escape(trend.test), html.escape(trend.phase), html.escape(trend.metric),
+            trend.value, html.escape(trend.unit), trend.refValue, html.escape(trend.unit), 100.0 * trend.change, verdict))
+    stream.write('</table>\n</body>\n</html>\n')
+
+
+def main():
+    optparser = optparse.OptionParser(
+        usage='\n\t%prog [OPTIONS] DATABASE',
+        version='%%prog')
+    optparser.add_option(
+        '--host', metavar='NAME',
+        type='string', dest='host', default=platform.node() or 'localhost',
+        help='host whose runs to report [default=%default]')
+    optparser.add_option(
+        '-r', '--revision', metavar='REVISION',
+        type='string', dest='revision', default=None,
+        help='revision to report [default: latest]')
+    optparser.add_option(
+        '-n', '--runs', metavar='NUMBER',
+        type='int', dest='runs', default=5,
+        help='number of previous runs of each test to compare against [default=%default]')
+    optparser.add_option(
+        '-t', '--threshold', metavar='FRACTION',
+        type='float', dest='threshold', default=0.10,
+        help='relative change deemed a regression or improvement [default=%default]')
+    optparser.add_option(
+        '-a', '--all',
+        action="store_true",
+        dest="all", default=False,
+        help="also list unchanged measurements")
+    optparser.add_option(
+        '--html', metavar='PATH',
+        type='string', dest='html', default=None,
+        help='also write an HTML report')
+    (options, args) = optparser.parse_args(sys.argv[1:])
+
+    if len(args) != 1:
+        optparser.error('wrong number of arguments')
+
+    db = connect(args[0])
+    try:
+        revision, previous, result = trends(db, options.host, options.revision, options.runs)
+    except ValueError as ex:
+        sys.stderr.write('error: %s\n' % ex)
+        sys.exit(1)
+    if revision is None:
+        sys.stderr.write('error: no runs on %s\n' % options.host)
+        sys.exit(1)
+
+    writeText(sys.stdout, revision, previous, result, options.threshold, options.all)
+    if options.html:
+        stream = open(options.html, 'wt')
+        writeHtml(stream, revision, previous, result, options.threshold)
+        stream.close()
+
+    regressions = [trend for trend in result if trend.verdict(options.threshold) == 'regressed']
+    sys.exit(int(bool(regressions)))
+
+
+if __name__ == '__main__':
+    main()
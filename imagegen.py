@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+##########################################################################
+#
+# Copyright 2026 apitrace-tests contributors
+# All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+#
+##########################################################################/
+
+'''Synthetic snapshot corpus generator.
+
+Writes two directories of PNG images with mixed resolutions, as `apitrace
+dump-images` would, which are identical except for a block of pixels in
+every few images, so that `apitrace diff-images` can be exercised at scale
+without checking thousands of images into the repository.
+'''
+
+
+import optparse
+import os
+import os.path
+import struct
+import sys
+import zlib
+
+
+# Mostly small snapshots, with the occasional large one
+RESOLUTIONS = [
+    (64, 64),
+    (128, 96),
+    (64, 64),
+    (256, 256),
+    (128, 96),
+    (320, 240),
+    (64, 64),
+    (640, 480),
+]
+
+
+def _chunk(kind, data):
+    return struct.pack('>I', len(data)) + kind + data + struct.pack('>I', zlib.crc32(kind + data) & 0xffffffff)
+
+
+def writePng(fileName, width, height, rows):
+    '''Write an 8-bit RGB PNG from a list of rows of packed pixels.'''
+    raw = b''.join([b'\0' + row for row in rows])
+    stream = open(fileName, 'wb')
+    stream.write(b'\x89PNG\r\n\x1a\n')
+    stream.write(_chunk(b'IHDR', struct.pack('>IIBBBBB', width, height, 8, 2, 0, 0, 0)))
+    stream.write(_chunk(b'IDAT', zlib.compress(raw, 1)))
+    stream.write(_chunk(b'IEND', b''))
+    stream.close()
+
+
+def imageRows(index, width, height):
+    '''Diagonal stripes, whose colors depend on the image index.'''
+    period = 61
+    pattern = bytes(bytearray([
+        (x * 4 + index * c * 37) % 256
+        for x in range(period)
+        for c in range(1, 4)
+    ]))
+    pattern = pattern * ((width + height) // period + 2)
+    return [pattern[y * 3 : (y + width) * 3] for y in range(height)]
+
+
+def generate(refDir, srcDir, count, step):
+    '''Returns the number of mismatching images.'''
+
+    for dirName in (refDir, srcDir):
+        if not os.path.exists(dirName):
+            os.makedirs(dirName)
+
+    mismatches = 0
+    for index in range(count):
+        width, height = RESOLUTIONS[index % len(RESOLUTIONS)]
+        rows = imageRows(index, width, height)
+        fileName = '%04u.png' % index
+        writePng(os.path.join(refDir, fileName), width, height, rows)
+        if step and index % step == step - 1:
+            # Invert an 8x8 block in the middle
+            x = width // 2 * 3
+            for y in range(height // 2, height // 2 + 8):
+                row = bytearray(rows[y])
+                row[x : x + 24] = bytes(bytearray([255 - c for c in row[x : x + 24]]))
+                rows[y] = bytes(row)
+            mismatches += 1
+        writePng(os.path.join(srcDir, fileName), width, height, rows)
+    return mismatches
+
+
+def main(argv = None):
+    if argv is None:
+        argv = sys.argv[1:]
+
+    optparser = optparse.OptionParser(
+        usage='\n\t%prog [OPTIONS] REF_DIR SRC_DIR',
+        version='%%prog')
+    optparser.add_option(
+        '--count', metavar='NUMBER',
+        type='int', dest='count', default=1000,
+        help='number of images [default: %default]')
+    optparser.add_option(
+        '--mismatch-step', metavar='NUMBER',
+        type='int', dest='step', default=0,
+        help='make every NUMBER-th source image differ [default: never]')
+
+    (options, args) = optparser.parse_args(argv)
+    if len(args) != 2:
+        optparser.error('a reference and a source directory must be specified')
+    refDir, srcDir = args
+
+    mismatches = generate(refDir, srcDir, options.count, options.step)
+
+    sys.stdout.write('%s, %s: %u images, %u mismatches\n' % (refDir, srcDir, options.count, mismatches))
+    sys.stdout.flush()
+
+    return mismatches
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,348 @@
+#!/usr/bin/env python3
+##########################################################################
+#
+# Copyright 2026 apitrace-tests contributors
+# All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+#
+##########################################################################/
+
+'''Split the ctest suite into shards of balanced cost, run them, and merge
+their results.'''
+
+
+import json
+import optparse
+import os.path
+import subprocess
+import sys
+import xml.etree.ElementTree as ElementTree
+
+import benchmark
+
+
+def listTests(buildDir, ctest = 'ctest', ctestArgs = []):
+    '''Return the names of the tests, in ctest order.'''
+
+    output = subprocess.check_output([ctest, '--show-only=json-v1'] + ctestArgs,
+                                     cwd=buildDir, universal_newlines=True)
+    return [test['name'] for test in json.loads(output)['tests']]
+
+
+def readCosts(fileName):
+    '''Read the average test durations ctest records in
+    Testing/Temporary/CTestCostData.txt.'''
+
+    costs = {}
+    if not os.path.exists(fileName):
+        return costs
+    for line in open(fileName, 'rt'):
+        if line.startswith('---'):
+            # Failed tests follow
+            break
+        fields = line.split()
+        if len(fields) != 3:
+            continue
+        name, runs, cost = fields
+        try:
+            costs[name] = float(cost)
+        except ValueError:
+            continue
+    return costs
+
+
+def assign(names, costs, count):
+    '''Deterministically assign tests to count shards of balanced total cost,
+    returning a list of shards, each a list of (index, name) tuples, where
+    index is the 1-based ctest test number.
+
+    Tests are placed from the costliest down, each into the least loaded
+    shard.  Tests without recorded cost are deemed to cost the median.'''
+
+    known = [costs[name] for name in names if name in costs]
+    default = benchmark.median(known) or 1.0
+    tests = [(costs.get(name, default), index + 1, name) for index, name in enumerate(names)]
+    tests.sort(key=lambda test: (-test[0], test[2]))
+
+    loads = [0.0] * count
+    shards = [[] for i in range(count)]
+    for cost, index, name in tests:
+        shard = loads.index(min(loads))
+        loads[shard] += cost
+        shards[shard].append((index, name))
+    for shard in shards:
+        shard.sort()
+    return shards, loads
+
+
+def parseShard(value):
+    try:
+        index, count = [int(item) for item in value.split('/')]
+    except ValueError:
+        raise optparse.OptionValueError('invalid shard %r, expected i/n' % value)
+    if count < 1 or index < 1 or index > count:
+        raise optparse.OptionValueError('invalid shard %r, expected 1 <= i <= n' % value)
+    return index, count
+
+
+def ctestCommand(options, tests, junit):
+    cmd = [options.ctest, '--output-on-failure', '--output-junit', os.path.abspath(junit)]
+    if options.jobs:
+        cmd += ['-j', str(options.jobs)]
+    cmd += ['-I', '0,0,0,' + ','.join([str(index) for index, name in tests])]
+    return cmd + options.ctest_args
+
+
+def readResults(fileName):
+    '''Read the test results of a JUnit XML file written by ctest, or of a
+    JSON file written by merge.'''
+
+    if fileName.endswith('.json'):
+        return json.load(open(fileName, 'rt'))['tests']
+
+    results = []
+    root = ElementTree.parse(fileName).getroot()
+    if root.tag == 'testsuite':
+        suites = [root]
+    else:
+        suites = root.findall('testsuite')
+    for suite in suites:
+        for testcase in suite.findall('testcase'):
+            status = testcase.get('status')
+            if status is None:
+                if testcase.find('failure') is not None or testcase.find('error') is not None:
+                    status = 'fail'
+                elif testcase.find('skipped') is not None:
+                    status = 'skipped'
+                else:
+                    status = 'run'
+            output = testcase.findtext('system-out') or ''
+            results.append({
+                'name': testcase.get('name'),
+                'status': status,
+                'time': float(testcase.get('time') or 0.0),
+                'output': output,
+                'source': os.path.basename(fileName),
+            })
+    return results
+
+
+def writeJunit(fileName, results):
+    failures = len([result for result in results if result['status'] == 'fail'])
+    skipped = len([result for result in results if result['status'] in ('skipped', 'disabled', 'notrun')])
+    total = sum([result['time'] for result in results])
+    suite = ElementTree.Element('testsuite', {
+        'name': 'apitrace-tests',
+        'tests': str(len(results)),
+        'failures': str(failures),
+        'skipped': str(skipped),
+        'time': '%.3f' % total,
+    })
+    for result in results:
+        testcase = ElementTree.SubElement(suite, 'testcase', {
+            'name': result['name'],
+            'classname': result['name'],
+            'time': '%.3f' % result['time'],
+            'status': result['status'],
+        })
+        if result['status'] == 'fail':
+            ElementTree.SubElement(testcase, 'failure', {'message': 'Failed'})
+        elif result['status'] in ('skipped', 'disabled', 'notrun'):
+            ElementTree.SubElement(testcase, 'skipped', {'message': result['status']})
+        if result.get('output'):
+            ElementTree.SubElement(testcase, 'system-out').text = result['output']
+    ElementTree.ElementTree(suite).write(fileName, encoding='utf-8', xml_declaration=True)
+
+
+def writeJson(fileName, results):
+    summary = {}
+    for result in results:
+        summary[result['status']] = summary.get(result['status'], 0) + 1
+    stream = open(fileName, 'wt')
+    json.dump({'summary': summary, 'tests': results}, stream, sort_keys=True, indent=2)
+    stream.write('\n')
+    stream.close()
+
+
+def merge(fileNames, junit = None, jsonFileName = None):
+    '''Merge the results of several shards into one report, returning the
+    merged results.'''
+
+    results = []
+    seen = {}
+    for fileName in fileNames:
+        for result in readResults(fileName):
+            name = result['name']
+            if name in seen:
+                sys.stderr.write('warning: %s ran in both %s and %s\n' % (name, seen[name], result['source']))
+            seen[name] = result['source']
+            results.append(result)
+    results.sort(key=lambda result: result['name'])
+    if junit:
+        writeJunit(junit, results)
+    if jsonFileName:
+        writeJson(jsonFileName, results)
+    return results
+
+
+def summarize(results):
+    failed = [result['name'] for result in results if result['status'] == 'fail']
+    sys.stdout.write('%u tests, %u failed\n' % (len(results), len(failed)))
+    for name in failed:
+        sys.stdout.write('  %s\n' % name)
+    return not failed
+
+
+def main():
+    optparser = optparse.OptionParser(
+        usage='\n\t%prog [OPTIONS] list|run|local|merge [ARGS] ...\n\n'
+              '\tlist   show the tests of --shard, or of every shard\n'
+              '\trun    run the tests of --shard\n'
+              '\tlocal  run every shard as a separate process on this host, and merge their results\n'
+              '\tmerge  merge JUnit or JSON results given as arguments',
+        version='%%prog')
+    optparser.add_option(
+        '-B', '--build-dir', metavar='PATH',
+        type='string', dest='build_dir', default='.',
+        help='ctest build directory [default=%default]')
+    optparser.add_option(
+        '--ctest', metavar='PROGRAM',
+        type='string', dest='ctest', default='ctest',
+        help='path to ctest executable')
+    optparser.add_option(
+        '--ctest-arg', metavar='ARG',
+        type='string', dest='ctest_args', action='append', default=[],
+        help='extra ctest argument, such as -L or -LE label filters')
+    optparser.add_option(
+        '-s', '--shard', metavar='I/N',
+        type='string', dest='shard', default=None,
+        help='shard to list or run, numbered from 1')
+    optparser.add_option(
+        '-n', '--shards', metavar='N',
+        type='int', dest='shards', default=None,
+        help='number of shards for list and local')
+    optparser.add_option(
+        '--costs', metavar='PATH',
+        type='string', dest='costs', default=None,
+        help='ctest cost data with recorded durations [default: BUILD_DIR/Testing/Temporary/CTestCostData.txt]')
+    optparser.add_option(
+        '-j', '--jobs', metavar='N',
+        type='int', dest='jobs', default=None,
+        help='parallel tests within a shard')
+    optparser.add_option(
+        '-o', '--output-dir', metavar='PATH',
+        type='string', dest='output_dir', default='.',
+        help='directory for shard results [default=%default]')
+    optparser.add_option(
+        '--junit', metavar='PATH',
+        type='string', dest='junit', default=None,
+        help='merged JUnit XML report')
+    optparser.add_option(
+        '--json', metavar='PATH',
+        type='string', dest='json', default=None,
+        help='merged JSON report')
+    (options, args) = optparser.parse_args(sys.argv[1:])
+
+    if not args:
+        optparser.error('a command must be specified')
+    command = args.pop(0)
+
+    if command == 'merge':
+        if not args:
+            optparser.error('no results to merge')
+        results = merge(args, options.junit, options.json)
+        sys.exit(0 if summarize(results) else 1)
+
+    index = None
+    count = options.shards
+    if options.shard is not None:
+        try:
+            index, count = parseShard(options.shard)
+        except optparse.OptionValueError as ex:
+            optparser.error(str(ex))
+    if count is None:
+        optparser.error('either --shard or --shards must be specified')
+
+    costsFileName = options.costs
+    if costsFileName is None:
+        costsFileName = os.path.join(options.build_dir, 'Testing', 'Temporary', 'CTestCostData.txt')
+    costs = readCosts(costsFileName)
+    names = listTests(options.build_dir, options.ctest, options.ctest_args)
+    shards, loads = assign(names, costs, count)
+
+    if not os.path.exists(options.output_dir):
+        os.makedirs(options.output_dir)
+
+    if command == 'list':
+        for i in range(count):
+            if index is not None and i + 1 != index:
+                continue
+            sys.stdout.write('shard %u/%u: %u tests, cost %.1f\n' % (i + 1, count, len(shards[i]), loads[i]))
+            for testIndex, name in shards[i]:
+                sys.stdout.write('  %s\n' % name)
+        sys.exit(0)
+
+    if command == 'run':
+        if index is None:
+            optparser.error('run requires --shard')
+        junit = os.path.join(options.output_dir, 'shard-%u-of-%u.xml' % (index, count))
+        if shards[index - 1]:
+            cmd = ctestCommand(options, shards[index - 1], junit)
+            sys.stdout.write(' '.join(cmd) + '\n')
+            sys.stdout.flush()
+            returncode = subprocess.call(cmd, cwd=options.build_dir)
+        else:
+            # More shards than tests; ctest would complain about no tests
+            writeJunit(junit, [])
+            returncode = 0
+        if options.junit or options.json:
+            merge([junit], options.junit, options.json)
+        sys.exit(returncode)
+
+    if command == 'local':
+        # Shards share the build directory, but were assigned above, so the
+        # cost data ctest updates as they run does not affect them
+        procs = []
+        junits = []
+        for i in range(count):
+            junit = os.path.join(options.output_dir, 'shard-%u-of-%u.xml' % (i + 1, count))
+            if not shards[i]:
+                continue
+            log = open(os.path.join(options.output_dir, 'shard-%u-of-%u.log' % (i + 1, count)), 'wt')
+            cmd = ctestCommand(options, shards[i], junit)
+            sys.stdout.write('shard %u/%u: %s\n' % (i + 1, count, ' '.join(cmd)))
+            procs.append((subprocess.Popen(cmd, cwd=options.build_dir, stdout=log, stderr=subprocess.STDOUT), log))
+            junits.append(junit)
+        sys.stdout.flush()
+        for proc, log in procs:
+            proc.wait()
+            log.close()
+        junits = [junit for junit in junits if os.path.exists(junit)]
+        results = merge(junits, options.junit, options.json)
+        ok = summarize(results) and len(results) == len(names)
+        if len(results) != len(names):
+            sys.stdout.write('expected %u results but got %u\n' % (len(names), len(results)))
+        sys.exit(0 if ok else 1)
+
+    optparser.error('unknown command %s' % command)
+
+
+if __name__ == '__main__':
+    main()
@@ -48,8 +48,27 @@ class AsciiComparer:
             lines.append(line)
         return lines
 
+    def compareDigest(self, refDigest, refNumLines):
+        srcDigest, srcNumLines = digest_lines(self.srcStream)
+        if srcNumLines != refNumLines:
+            fail('mismatch: expected %u lines but got %u' % (refNumLines, srcNumLines))
+        if srcDigest != refDigest:
+            fail('mismatch: expected sha256 %s but got %s' % (refDigest, srcDigest))
+
     def compare(self):
         refLines = self.readLines(self.refStream)
+
+        # A `#sha256 <hex> <lines>` line replaces the expected output of huge
+        # dumps, so that the output is hashed as it streams instead of stored
+        if len(refLines) == 1 and refLines[0].startswith('#sha256 '):
+            try:
+                refDigest, refNumLines = refLines[0].split()[1:]
+                refNumLines = int(refNumLines)
+            except ValueError:
+                fail('Broken test script: malformed digest: %r' % refLines[0])
+            self.compareDigest(refDigest.lower(), refNumLines)
+            return
+
         srcLines = self.readLines(self.srcStream)
 
         numLines = max(len(refLines), len(srcLines))
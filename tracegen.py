@@ -0,0 +1,588 @@
+#!/usr/bin/env python3
+##########################################################################
+#
+# Copyright 2026 apitrace-tests contributors
+# All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+#
+##########################################################################/
+
+'''Synthetic trace generator.
+
+Writes GLX traces of arbitrary size in the apitrace binary format, so that
+scalability tests don't need huge traces checked into the repository.  See
+trace_format.hpp in the apitrace source tree for a description of the format.
+The output is zlib (gzip) compressed, which apitrace reads transparently.
+'''
+
+
+import array
+import gzip
+import optparse
+import random
+import struct
+import sys
+
+
+TRACE_VERSION = 5
+
+EVENT_ENTER, EVENT_LEAVE = range(2)
+
+CALL_END, CALL_ARG, CALL_RET, CALL_THREAD, CALL_BACKTRACE, CALL_FLAGS = range(6)
+
+TYPE_NULL, TYPE_FALSE, TYPE_TRUE, TYPE_SINT, TYPE_UINT, TYPE_FLOAT, TYPE_DOUBLE, \
+TYPE_STRING, TYPE_BLOB, TYPE_ENUM, TYPE_BITMASK, TYPE_ARRAY, TYPE_STRUCT, \
+TYPE_OPAQUE, TYPE_REPR, TYPE_WSTRING = range(16)
+
+
+class FunctionSig:
+
+    def __init__(self, id, name, argNames):
+        self.id = id
+        self.name = name
+        self.argNames = argNames
+
+
+class EnumSig:
+
+    def __init__(self, id, values):
+        self.id = id
+        self.values = values
+
+
+class BitmaskSig:
+
+    def __init__(self, id, flags):
+        self.id = id
+        self.flags = flags
+
+
+class TraceWriter:
+    '''Mirrors trace::Writer from the apitrace source tree.'''
+
+    def __init__(self, stream, version = TRACE_VERSION):
+        self.stream = stream
+        self.version = version
+        self.buf = bytearray()
+        self.callNo = 0
+        self.sigs = set()
+        self._writeUInt(version)
+
+    def flush(self):
+        self.stream.write(self.buf)
+        self.buf = bytearray()
+
+    def close(self):
+        self.flush()
+        self.stream.close()
+
+    def _writeByte(self, c):
+        self.buf.append(c)
+
+    def _writeUInt(self, value):
+        assert value >= 0
+        while value >= 0x80:
+            self.buf.append((value & 0x7f) | 0x80)
+            value >>= 7
+        self.buf.append(value)
+
+    def _writeString(self, data):
+        if isinstance(data, str):
+            data = data.encode('utf-8')
+        self._writeUInt(len(data))
+        self.buf += data
+
+    def _registerSig(self, kind, sig):
+        '''Returns whether the signature still needs to be written out.'''
+        key = (kind, sig.id)
+        if key in self.sigs:
+            return False
+        self.sigs.add(key)
+        return True
+
+    def beginEnter(self, sig, threadNo = 0):
+        self._writeByte(EVENT_ENTER)
+        if self.version >= 4:
+            self._writeUInt(threadNo)
+        self._writeUInt(sig.id)
+        if self._registerSig(FunctionSig, sig):
+            self._writeString(sig.name)
+            self._writeUInt(len(sig.argNames))
+            for argName in sig.argNames:
+                self._writeString(argName)
+        callNo = self.callNo
+        self.callNo += 1
+        return callNo
+
+    def endEnter(self):
+        self._writeByte(CALL_END)
+
+    def beginLeave(self, callNo):
+        self._writeByte(EVENT_LEAVE)
+        self._writeUInt(callNo)
+
+    def endLeave(self):
+        self._writeByte(CALL_END)
+        if len(self.buf) >= 1 << 20:
+            self.flush()
+
+    def beginArg(self, index):
+        self._writeByte(CALL_ARG)
+        self._writeUInt(index)
+
+    def beginReturn(self):
+        self._writeByte(CALL_RET)
+
+    def writeNull(self):
+        self._writeByte(TYPE_NULL)
+
+    def writeBool(self, value):
+        self._writeByte(TYPE_TRUE if value else TYPE_FALSE)
+
+    def writeSInt(self, value):
+        if value < 0:
+            self._writeByte(TYPE_SINT)
+            self._writeUInt(-value)
+        else:
+            self._writeByte(TYPE_UINT)
+            self._writeUInt(value)
+
+    def writeUInt(self, value):
+        self._writeByte(TYPE_UINT)
+        self._writeUInt(value)
+
+    def writeFloat(self, value):
+        self._writeByte(TYPE_FLOAT)
+        self.buf += struct.pack('<f', value)
+
+    def writeDouble(self, value):
+        self._writeByte(TYPE_DOUBLE)
+        self.buf += struct.pack('<d', value)
+
+    def writeString(self, value):
+        self._writeByte(TYPE_STRING)
+        self._writeString(value)
+
+    def writeBlob(self, data):
+        self._writeByte(TYPE_BLOB)
+        self._writeString(data)
+
+    def writeEnum(self, sig, value):
+        self._writeByte(TYPE_ENUM)
+        self._writeUInt(sig.id)
+        if self._registerSig(EnumSig, sig):
+            self._writeUInt(len(sig.values))
+            for name, enumValue in sig.values:
+                self._writeString(name)
+                self.writeSInt(enumValue)
+        self.writeSInt(value)
+
+    def writeBitmask(self, sig, value):
+        self._writeByte(TYPE_BITMASK)
+        self._writeUInt(sig.id)
+        if self._registerSig(BitmaskSig, sig):
+            self._writeUInt(len(sig.flags))
+            for name, flagValue in sig.flags:
+                self._writeString(name)
+                self._writeUInt(flagValue)
+        self._writeUInt(value)
+
+    def writePointer(self, addr):
+        if not addr:
+            self.writeNull()
+            return
+        self._writeByte(TYPE_OPAQUE)
+        self._writeUInt(addr)
+
+    def beginArray(self, length):
+        self._writeByte(TYPE_ARRAY)
+        self._writeUInt(length)
+
+
+#######################################################################
+
+_Bool_sig = EnumSig(0, [('False', 0), ('True', 1)])
+_GLenum_sig = EnumSig(1, [
+    ('GL_TRIANGLES', 0x0004),
+    ('GL_ARRAY_BUFFER', 0x8892),
+    ('GL_STREAM_DRAW', 0x88E0),
+    ('GL_FRAGMENT_SHADER', 0x8B30),
+])
+_GLbitfield_clear_sig = BitmaskSig(0, [
+    ('GL_DEPTH_BUFFER_BIT', 0x00000100),
+    ('GL_ACCUM_BUFFER_BIT', 0x00000200),
+    ('GL_STENCIL_BUFFER_BIT', 0x00000400),
+    ('GL_COLOR_BUFFER_BIT', 0x00004000),
+])
+
+_glXCreateContext_sig = FunctionSig(0, 'glXCreateContext', ['dpy', 'vis', 'shareList', 'direct'])
+_glXMakeCurrent_sig = FunctionSig(1, 'glXMakeCurrent', ['dpy', 'drawable', 'ctx'])
+_glXSwapBuffers_sig = FunctionSig(2, 'glXSwapBuffers', ['dpy', 'drawable'])
+_glClearColor_sig = FunctionSig(3, 'glClearColor', ['red', 'green', 'blue', 'alpha'])
+_glClear_sig = FunctionSig(4, 'glClear', ['mask'])
+_glBegin_sig = FunctionSig(5, 'glBegin', ['mode'])
+_glColor3f_sig = FunctionSig(6, 'glColor3f', ['red', 'green', 'blue'])
+_glVertex3f_sig = FunctionSig(7, 'glVertex3f', ['x', 'y', 'z'])
+_glEnd_sig = FunctionSig(8, 'glEnd', [])
+_glGenBuffers_sig = FunctionSig(9, 'glGenBuffers', ['n', 'buffer'])
+_glBindBuffer_sig = FunctionSig(10, 'glBindBuffer', ['target', 'buffer'])
+_glBufferData_sig = FunctionSig(11, 'glBufferData', ['target', 'size', 'data', 'usage'])
+_glCreateShader_sig = FunctionSig(12, 'glCreateShader', ['type'])
+_glShaderSource_sig = FunctionSig(13, 'glShaderSource', ['shader', 'count', 'string', 'length'])
+_glCompileShader_sig = FunctionSig(14, 'glCompileShader', ['shader'])
+
+DPY = 0x1da4360
+VISUAL = 0x1daf630
+CONTEXT_BASE = 0x1e1cad0
+DRAWABLE_BASE = 62914565
+
+
+class GLWriter(TraceWriter):
+    '''Helper to emit the handful of GLX/GL calls the generator needs.'''
+
+    def _call(self, threadNo, sig, args, ret = None):
+        callNo = self.beginEnter(sig, threadNo)
+        for index, writeArg in enumerate(args):
+            self.beginArg(index)
+            writeArg()
+        self.endEnter()
+        self.beginLeave(callNo)
+        if ret is not None:
+            self.beginReturn()
+            ret()
+        self.endLeave()
+
+    def glXCreateContext(self, threadNo, ctx):
+        self._call(threadNo, _glXCreateContext_sig, [
+            lambda: self.writePointer(DPY),
+            lambda: self.writePointer(VISUAL),
+            self.writeNull,
+            lambda: self.writeEnum(_Bool_sig, 1),
+        ], lambda: self.writePointer(ctx))
+
+    def glXMakeCurrent(self, threadNo, drawable, ctx):
+        self._call(threadNo, _glXMakeCurrent_sig, [
+            lambda: self.writePointer(DPY),
+            lambda: self.writeUInt(drawable),
+            lambda: self.writePointer(ctx),
+        ], lambda: self.writeEnum(_Bool_sig, 1))
+
+    def glXSwapBuffers(self, threadNo, drawable):
+        self._call(threadNo, _glXSwapBuffers_sig, [
+            lambda: self.writePointer(DPY),
+            lambda: self.writeUInt(drawable),
+        ])
+
+    def glClearColor(self, threadNo, red, green, blue, alpha):
+        self._call(threadNo, _glClearColor_sig, [
+            lambda: self.writeFloat(red),
+            lambda: self.writeFloat(green),
+            lambda: self.writeFloat(blue),
+            lambda: self.writeFloat(alpha),
+        ])
+
+    def glClear(self, threadNo, mask):
+        self._call(threadNo, _glClear_sig, [
+            lambda: self.writeBitmask(_GLbitfield_clear_sig, mask),
+        ])
+
+    def glBegin(self, threadNo, mode):
+        self._call(threadNo, _glBegin_sig, [
+            lambda: self.writeEnum(_GLenum_sig, mode),
+        ])
+
+    def glColor3f(self, threadNo, red, green, blue):
+        self._call(threadNo, _glColor3f_sig, [
+            lambda: self.writeFloat(red),
+            lambda: self.writeFloat(green),
+            lambda: self.writeFloat(blue),
+        ])
+
+    def glVertex3f(self, threadNo, x, y, z):
+        self._call(threadNo, _glVertex3f_sig, [
+            lambda: self.writeFloat(x),
+            lambda: self.writeFloat(y),
+            lambda: self.writeFloat(z),
+        ])
+
+    def glEnd(self, threadNo):
+        self._call(threadNo, _glEnd_sig, [])
+
+    def glGenBuffers(self, threadNo, buffer):
+        def writeBuffers():
+            self.beginArray(1)
+            self.writeUInt(buffer)
+        self._call(threadNo, _glGenBuffers_sig, [
+            lambda: self.writeSInt(1),
+            writeBuffers,
+        ])
+
+    def glBindBuffer(self, threadNo, target, buffer):
+        self._call(threadNo, _glBindBuffer_sig, [
+            lambda: self.writeEnum(_GLenum_sig, target),
+            lambda: self.writeUInt(buffer),
+        ])
+
+    def glBufferData(self, threadNo, target, data, usage):
+        self._call(threadNo, _glBufferData_sig, [
+            lambda: self.writeEnum(_GLenum_sig, target),
+            lambda: self.writeSInt(len(data)),
+            lambda: self.writeBlob(data),
+            lambda: self.writeEnum(_GLenum_sig, usage),
+        ])
+
+    def glCreateShader(self, threadNo, type, shader):
+        self._call(threadNo, _glCreateShader_sig, [
+            lambda: self.writeEnum(_GLenum_sig, type),
+        ], lambda: self.writeUInt(shader))
+
+    def glShaderSource(self, threadNo, shader, source):
+        def writeStrings():
+            self.beginArray(1)
+            self.writeString(source)
+        self._call(threadNo, _glShaderSource_sig, [
+            lambda: self.writeUInt(shader),
+            lambda: self.writeSInt(1),
+            writeStrings,
+            self.writeNull,
+        ])
+
+    def glCompileShader(self, threadNo, shader):
+        self._call(threadNo, _glCompileShader_sig, [
+            lambda: self.writeUInt(shader),
+        ])
+
+
+def shaderSource(index, size, patched = False):
+    '''Deterministic fragment shader of approximately the given size.  The
+    patched variant differs only in its last statement.'''
+    lines = [
+        '#version 120\n',
+        'uniform vec4 color%u;\n' % index,
+    ]
+    length = sum(map(len, lines))
+    term = 0
+    body = []
+    while length < size:
+        line = '    c += color%u * %u.0;\n' % (index, term)
+        body.append(line)
+        length += len(line)
+        term += 1
+    lines.append('void main() {\n')
+    lines.append('    vec4 c = vec4(0.0);\n')
+    lines += body
+    if patched:
+        lines.append('    gl_FragColor = 2.0 * c;\n')
+    else:
+        lines.append('    gl_FragColor = c;\n')
+    lines.append('}\n')
+    return ''.join(lines)
+
+
+class Generator:
+    '''Emits a simple GLX workload, with one context/drawable per thread and
+    every thread drawing and swapping its own frames.  Calls from different
+    threads are interleaved one by one.'''
+
+    def __init__(self, writer, options):
+        self.writer = writer
+        self.options = options
+        self.frames = 0
+
+    def threadSetup(self, threadNo):
+        writer = self.writer
+        ctx = CONTEXT_BASE + threadNo * 0x1000
+        drawable = DRAWABLE_BASE + threadNo
+        yield lambda: writer.glXCreateContext(threadNo, ctx)
+        yield lambda: writer.glXMakeCurrent(threadNo, drawable, ctx)
+        if self.options.blob_size:
+            yield lambda: writer.glGenBuffers(threadNo, 1)
+            yield lambda: writer.glBindBuffer(threadNo, 0x8892, 1)
+        for index in range(self.options.shaders):
+            shader = 1 + index
+            sourceNo = threadNo * self.options.shaders + index
+            patched = self.options.patch and sourceNo == self.options.sed_shader
+            source = shaderSource(sourceNo, self.options.shader_size, patched)
+            yield lambda shader=shader: writer.glCreateShader(threadNo, 0x8B30, shader)
+            yield lambda shader=shader, source=source: writer.glShaderSource(threadNo, shader, source)
+            yield lambda shader=shader: writer.glCompileShader(threadNo, shader)
+
+    def threadFrame(self, threadNo, frameNo):
+        writer = self.writer
+        drawable = DRAWABLE_BASE + threadNo
+        shade = float((frameNo + threadNo) % 256) / 256.0
+        yield lambda: writer.glClearColor(threadNo, shade, 0.1, 0.3, 1.0)
+        yield lambda: writer.glClear(threadNo, 0x00004000)
+        if self.options.blob_size:
+            data = blobData(frameNo, self.options.blob_size)
+            yield lambda: writer.glBufferData(threadNo, 0x8892, data, 0x88E0)
+        for drawNo in range(self.options.draws):
+            z = float(-drawNo)
+            yield lambda: writer.glBegin(threadNo, 0x0004)
+            yield lambda: writer.glColor3f(threadNo, 0.8, 0.0, 0.0)
+            yield lambda z=z: writer.glVertex3f(threadNo, -0.9, -0.9, z)
+            yield lambda: writer.glColor3f(threadNo, 0.0, 0.9, 0.0)
+            yield lambda z=z: writer.glVertex3f(threadNo, 0.9, -0.9, z)
+            yield lambda: writer.glColor3f(threadNo, 0.0, 0.0, 0.7)
+            yield lambda z=z: writer.glVertex3f(threadNo, 0.0, 0.9, z)
+            yield lambda: writer.glEnd(threadNo)
+        yield lambda: writer.glXSwapBuffers(threadNo, drawable)
+
+    def _interleave(self, streams):
+        streams = list(streams)
+        while streams:
+            for stream in list(streams):
+                try:
+                    emit = next(stream)
+                except StopIteration:
+                    streams.remove(stream)
+                else:
+                    emit()
+
+    def generate(self):
+        threads = range(self.options.threads)
+        self._interleave([self.threadSetup(threadNo) for threadNo in threads])
+        for frameNo in range(self.options.frames):
+            self._interleave([self.threadFrame(threadNo, frameNo) for threadNo in threads])
+            self.frames += len(threads)
+
+
+def blobData(seed, size):
+    '''Vertex-like data -- a slowly varying float sequence with some noise --
+    so that it compresses roughly like real geometry does.'''
+    rng = random.Random(seed)
+    count = (size + 3) // 4
+    values = array.array('f', [i * 0.001 + rng.random() * 0.01 for i in range(count)])
+    return values.tobytes()[:size]
+
+
+def writeCallSet(fileName, numCalls, step = 1, span = 1):
+    '''Write a call-set file with one entry per line, as accepted by the
+    --calls=@FILE option.'''
+    stream = open(fileName, 'wt')
+    for callNo in range(0, numCalls, step):
+        last = min(callNo + span, numCalls) - 1
+        if last == callNo:
+            stream.write('%u\n' % callNo)
+        else:
+            stream.write('%u-%u\n' % (callNo, last))
+    stream.close()
+
+
+def writeShader(fileName, index, size, patched = False):
+    '''Write a shader source, as accepted by `apitrace sed`'s @file().'''
+    stream = open(fileName, 'wt')
+    stream.write(shaderSource(index, size, patched))
+    stream.close()
+
+
+def createOptParser():
+    optparser = optparse.OptionParser(
+        usage='\n\t%prog [OPTIONS] -o OUTPUT',
+        version='%%prog')
+    optparser.add_option(
+        '-o', '--output', metavar='TRACE',
+        type='string', dest='output',
+        help='output trace')
+    optparser.add_option(
+        '--frames', metavar='NUMBER',
+        type='int', dest='frames', default=1,
+        help='frames per thread [default: %default]')
+    optparser.add_option(
+        '--threads', metavar='NUMBER',
+        type='int', dest='threads', default=1,
+        help='number of threads [default: %default]')
+    optparser.add_option(
+        '--draws', metavar='NUMBER',
+        type='int', dest='draws', default=1,
+        help='triangles drawn per frame [default: %default]')
+    optparser.add_option(
+        '--blob-size', metavar='BYTES',
+        type='int', dest='blob_size', default=0,
+        help='size of the buffer uploaded every frame [default: %default]')
+    optparser.add_option(
+        '--shaders', metavar='NUMBER',
+        type='int', dest='shaders', default=0,
+        help='shaders sources per thread [default: %default]')
+    optparser.add_option(
+        '--shader-size', metavar='BYTES',
+        type='int', dest='shader_size', default=1024,
+        help='approximate size of each shader source [default: %default]')
+    optparser.add_option(
+        '--sed-shader', metavar='NUMBER',
+        type='int', dest='sed_shader', default=0,
+        help='shader source the following options refer to [default: %default]')
+    optparser.add_option(
+        '--patch',
+        action='store_true', dest='patch', default=False,
+        help='emit the patched variant of that shader source')
+    optparser.add_option(
+        '--search-file', metavar='FILE',
+        type='string', dest='search_file',
+        help='also write the original variant of that shader source')
+    optparser.add_option(
+        '--replace-file', metavar='FILE',
+        type='string', dest='replace_file',
+        help='also write the patched variant of that shader source')
+    optparser.add_option(
+        '--callset', metavar='FILE',
+        type='string', dest='callset',
+        help='also write a call-set file covering the generated trace')
+    optparser.add_option(
+        '--callset-step', metavar='NUMBER',
+        type='int', dest='callset_step', default=1,
+        help='distance between call-set entries [default: %default]')
+    optparser.add_option(
+        '--callset-span', metavar='NUMBER',
+        type='int', dest='callset_span', default=1,
+        help='calls covered by each call-set entry [default: %default]')
+    return optparser
+
+
+def main(argv = None):
+    if argv is None:
+        argv = sys.argv[1:]
+
+    optparser = createOptParser()
+    (options, args) = optparser.parse_args(argv)
+    if args or not options.output:
+        optparser.error('an output trace must be specified')
+
+    stream = gzip.open(options.output, 'wb', compresslevel=1)
+    writer = GLWriter(stream)
+    generator = Generator(writer, options)
+    generator.generate()
+    writer.close()
+
+    if options.search_file:
+        writeShader(options.search_file, options.sed_shader, options.shader_size)
+    if options.replace_file:
+        writeShader(options.replace_file, options.sed_shader, options.shader_size, True)
+    if options.callset:
+        writeCallSet(options.callset, writer.callNo, options.callset_step, options.callset_span)
+
+    sys.stdout.write('%s: %u calls, %u frames, %u threads\n' % (options.output, writer.callNo, generator.frames, options.threads))
+    sys.stdout.flush()
+
+    return writer.callNo
+
+
+if __name__ == '__main__':
+    main()
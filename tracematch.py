@@ -26,11 +26,22 @@
 
 
 import sys
+import mmap
 import optparse
 import string
 import os
 import re
+import stat
 import subprocess
+import concurrent.futures
+import multiprocessing
+import operator
+import itertools
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
 
 
 class MatchObject:
@@ -106,7 +117,7 @@ class ApproxMatcher(Matcher):
 
         error = abs(self.refValue - value)
         if self.refValue:
-            error = error / self.refValue
+            error = error / abs(self.refValue)
         return error <= self.tolerance
 
     def __str__(self):
@@ -121,15 +132,43 @@ def normalizeShaderDisassembly(value):
     return '\n'.join([line.strip() for line in value.split('\n') if line.strip() and not line.startswith('//')])
 
 
+# Normalized shader disassembly of every string seen, or None
+_shaderDisassemblies = {}
+
+def shaderDisassembly(value):
+    try:
+        return _shaderDisassemblies[value]
+    except KeyError:
+        pass
+    if isShaderDisassembly(value):
+        normalized = normalizeShaderDisassembly(value)
+    else:
+        normalized = None
+    _shaderDisassemblies[value] = normalized
+    return normalized
+
+
 class StringMatcher(Matcher):
 
     def __init__(self, refValue):
         self.refValue = refValue
+        self.refLength = len(refValue)
+        self.refHash = hash(refValue)
+        if isShaderDisassembly(refValue):
+            self.refShader = normalizeShaderDisassembly(refValue)
+        else:
+            self.refShader = None
 
     def match(self, value, mo):
-        if isShaderDisassembly(self.refValue) and isShaderDisassembly(value):
-            return normalizeShaderDisassembly(self.refValue) == normalizeShaderDisassembly(value)
-        return self.refValue == value
+        if value is self.refValue:
+            return True
+        if not isinstance(value, str):
+            return False
+        if len(value) == self.refLength and hash(value) == self.refHash and value == self.refValue:
+            return True
+        if self.refShader is not None:
+            return shaderDisassembly(value) == self.refShader
+        return False
 
     def __str__(self):
         return repr(self.refValue)
@@ -172,6 +211,52 @@ class ArrayMatcher(Matcher):
         return '{' + ', '.join(map(str, self.refElements)) + '}'
 
 
+class IntArrayMatcher(ArrayMatcher):
+    '''Array of integer literals, compared in one go.'''
+
+    def __init__(self, refElements):
+        ArrayMatcher.__init__(self, refElements)
+        self.refValues = [element.refValue for element in refElements]
+
+    def match(self, value, mo):
+        if not isinstance(value, (list, tuple)):
+            return False
+        return list(value) == self.refValues
+
+
+class FloatArrayMatcher(ArrayMatcher):
+    '''Array of approximate floats, compared as packed buffers with the
+    same relative tolerance as ApproxMatcher.'''
+
+    # Below this length numpy's overhead is not worth it
+    numpyThreshold = 64
+
+    def __init__(self, refElements):
+        ArrayMatcher.__init__(self, refElements)
+        self.refValues = [element.refValue for element in refElements]
+        self.maxErrors = [element.tolerance * (abs(element.refValue) or 1.0) for element in refElements]
+        if numpy is not None and len(refElements) >= self.numpyThreshold:
+            self.refArray = numpy.array(self.refValues, dtype=numpy.float64)
+            self.maxErrorArray = numpy.array(self.maxErrors, dtype=numpy.float64)
+        else:
+            self.refArray = None
+
+    def match(self, value, mo):
+        if not isinstance(value, (list, tuple)):
+            return False
+        if len(value) != len(self.refValues):
+            return False
+        if value and set(map(type, value)) != {float}:
+            return False
+        if value == self.refValues:
+            return True
+        if self.refArray is not None:
+            errors = numpy.abs(self.refArray - numpy.array(value, dtype=numpy.float64))
+            return bool(numpy.all(errors <= self.maxErrorArray))
+        errors = map(abs, map(operator.sub, self.refValues, value))
+        return all(map(operator.le, errors, self.maxErrors))
+
+
 class StructMatcher(Matcher):
 
     def __init__(self, refMembers):
@@ -267,43 +352,486 @@ class CallMatcher(Matcher):
         return s
 
 
+class RepeatMatcher:
+    '''A block of reference calls repeated between minCount and maxCount
+    times, where a maxCount of None means unbounded.'''
+
+    def __init__(self, calls, minCount, maxCount):
+        self.calls = calls
+        self.minCount = minCount
+        self.maxCount = maxCount
+
+    def __str__(self):
+        if self.maxCount is None:
+            s = 'repeat %u+' % self.minCount
+        elif self.maxCount == self.minCount:
+            s = 'repeat %u' % self.minCount
+        else:
+            s = 'repeat %u, %u' % (self.minCount, self.maxCount)
+        body = ''.join(['%s\n' % call for call in self.calls])
+        body = ''.join(['    ' + line for line in body.splitlines(True)])
+        return s + ' {\n' + body + '}'
+
+
 class TraceMismatch(Exception):
 
     pass
 
 
+def isFrameAnchor(functionName):
+    return functionName.find('SwapBuffers') != -1
+
+
+def splitFrames(items, getFunctionName):
+    '''Split a list of calls after every frame anchor.'''
+    frames = []
+    frame = []
+    for item in items:
+        frame.append(item)
+        if isFrameAnchor(getFunctionName(item)):
+            frames.append(frame)
+            frame = []
+    frames.append(frame)
+    return frames
+
+
+def _matchSequence(refCalls, srcCalls, mo, verbose = False):
+    srcCalls = iter(srcCalls)
+    for refCall in refCalls:
+        if verbose:
+            print(refCall)
+        skippedSrcCalls = []
+        while True:
+            try:
+                srcCall = next(srcCalls)
+            except StopIteration:
+                if skippedSrcCalls:
+                    raise TraceMismatch('missing call\n  %s\nfound\n  %s)' % (refCall, skippedSrcCalls[0]))
+                else:
+                    raise TraceMismatch('missing call\n  %s' % refCall)
+            if verbose:
+                print('\t%s %s%r = %r' % srcCall)
+            if refCall.match(srcCall, mo):
+                break
+            else:
+                skippedSrcCalls.append(srcCall)
+
+
+def _matchFrame(job):
+    '''Match one frame, returning the parameters it bound, or None on
+    mismatch.'''
+    refCalls, srcCalls, params = job
+    mo = MatchObject()
+    mo.params = dict(params)
+    try:
+        _matchSequence(refCalls, srcCalls, mo)
+    except TraceMismatch:
+        return None
+    return dict([(name, value) for name, value in mo.params.items() if name not in params])
+
+
+# Frames to match in forked worker processes, which inherit them rather than
+# having them pickled
+_frameJobs = []
+
+def _matchForkedFrame(index):
+    return _matchFrame(_frameJobs[index])
+
+
+def wildcardNames(matcher):
+    '''Names of the wildcards within a matcher.'''
+    names = set()
+    pending = [matcher]
+    while pending:
+        obj = pending.pop()
+        if isinstance(obj, WildcardMatcher):
+            if obj.name:
+                names.add(obj.name)
+        elif isinstance(obj, (list, tuple)):
+            pending.extend(obj)
+        elif isinstance(obj, dict):
+            pending.extend(obj.values())
+        elif isinstance(obj, (Matcher, RepeatMatcher)):
+            pending.extend(vars(obj).values())
+    return names
+
+
+# Instructions of the automaton repetitions are compiled into
+OP_CALL, OP_SPLIT, OP_JMP, OP_UNBIND, OP_MATCH = range(5)
+
+
+def compileCalls(calls):
+    '''Compile reference calls, possibly with repetitions, into a program
+    for a Thompson/Pike style automaton: (OP_CALL, matcher) advances to the
+    next instruction, (OP_SPLIT, x, y) continues at both x and y, preferring
+    x, (OP_JMP, x) continues at x, and (OP_UNBIND, names) forgets the given
+    wildcard bindings.
+
+    Wildcards first named inside a repeated block are rebound on every
+    repetition, so that they refer to the last one afterwards.'''
+
+    program = []
+    boundNames = set()
+
+    def emit(calls):
+        for call in calls:
+            if not isinstance(call, RepeatMatcher):
+                program.append((OP_CALL, call))
+                boundNames.update(wildcardNames(call))
+                continue
+            localNames = frozenset(wildcardNames(call) - boundNames)
+            def emitBody():
+                if localNames:
+                    program.append((OP_UNBIND, localNames))
+                emit(call.calls)
+            for i in range(call.minCount):
+                emitBody()
+            if call.maxCount is None:
+                split = len(program)
+                program.append(None)
+                emitBody()
+                program.append((OP_JMP, split))
+                program[split] = (OP_SPLIT, split + 1, len(program))
+            else:
+                splits = []
+                for i in range(call.maxCount - call.minCount):
+                    splits.append(len(program))
+                    program.append(None)
+                    emitBody()
+                for split in splits:
+                    program[split] = (OP_SPLIT, split + 1, len(program))
+            boundNames.update(localNames)
+
+    emit(calls)
+    program.append((OP_MATCH,))
+    return program
+
+
+def liveWildcardNames(program):
+    '''Return, for every instruction of a program, the names of the
+    wildcards that calls from it onwards may refer to before rebinding
+    them, and whose bindings may differ between threads.
+
+    Wildcards bound once and for all before the first split are the same in
+    every thread, so they are left out.'''
+
+    uses = [frozenset()] * len(program)
+    for pc, op in enumerate(program):
+        if op[0] == OP_CALL:
+            uses[pc] = frozenset(wildcardNames(op[1]))
+
+    live = [frozenset()] * len(program)
+    changed = True
+    while changed:
+        changed = False
+        for pc in range(len(program) - 1, -1, -1):
+            op = program[pc]
+            if op[0] == OP_CALL:
+                names = uses[pc] | live[pc + 1]
+            elif op[0] == OP_SPLIT:
+                names = live[op[1]] | live[op[2]]
+            elif op[0] == OP_JMP:
+                names = live[op[1]]
+            elif op[0] == OP_UNBIND:
+                names = live[pc + 1] - op[1]
+            else:
+                names = frozenset()
+            if names != live[pc]:
+                live[pc] = names
+                changed = True
+
+    common = set()
+    unbound = set()
+    for pc, op in enumerate(program):
+        if op[0] == OP_SPLIT:
+            break
+        common |= uses[pc]
+    for op in program:
+        if op[0] == OP_UNBIND:
+            unbound |= op[1]
+    common -= unbound
+
+    return [tuple(sorted(names - common)) for names in live]
+
+
 class TraceMatcher:
 
+    # Minimum number of source calls after the first frame to bother
+    # spawning worker processes for
+    parallelThreshold = 20000
+
     def __init__(self, calls):
         self.calls = calls
 
-    def match(self, calls, verbose = False):
+    def match(self, calls, verbose = False, threads = None, processes = 1):
+        '''Match the source calls, raising TraceMismatch on failure.  The
+        calls of every source thread, when known, are only needed by
+        ThreadedTraceMatcher.  Long sources are matched by up to the given
+        number of worker processes.'''
+        for call in self.calls:
+            if isinstance(call, RepeatMatcher):
+                return self._matchProgram(calls, verbose)
+        if not verbose and processes > 1:
+            mo = self._matchFrames(calls, processes)
+            if mo is not None:
+                return mo
         mo = MatchObject()
-        srcCalls = iter(calls)
-        for refCall in self.calls:
+        _matchSequence(self.calls, calls, mo, verbose)
+        return mo
+
+    def _matchProgram(self, calls, verbose = False):
+        '''Match a reference with repetitions, simulating all the automaton
+        threads in lockstep over the source calls.
+
+        As with plain references, each thread waits on its next reference
+        call, skipping source calls which don't match it.  Threads reaching
+        the same instruction with the same bindings of the wildcards still
+        to be referred to are merged, keeping the preferred one, so the
+        matching time is linear on the number of source calls for
+        references whose wildcards are not carried out of repetitions.'''
+
+        program = compileCalls(self.calls)
+        live = liveWildcardNames(program)
+
+        # Threads at the same instruction are only interchangeable if they
+        # agree on the wildcards still to be referred to
+        def threadKey(pc, params):
+            names = live[pc]
+            if not names:
+                return pc
+            values = tuple([params.get(name) for name in names])
+            try:
+                hash(values)
+            except TypeError:
+                values = tuple([repr(value) for value in values])
+            return (pc,) + values
+
+        # Each thread is a (pc, params, numMatched, firstSkipped) tuple
+        def addThread(threads, seen, pc, params, numMatched):
+            pending = [(pc, params)]
+            first = True
+            while pending:
+                pc, params = pending.pop()
+                key = threadKey(pc, params)
+                if key in seen:
+                    continue
+                seen.add(key)
+                op = program[pc]
+                if op[0] == OP_JMP:
+                    pending.append((op[1], params))
+                elif op[0] == OP_SPLIT:
+                    pending.append((op[2], params))
+                    pending.append((op[1], params))
+                elif op[0] == OP_UNBIND:
+                    params = dict([item for item in params.items() if item[0] not in op[1]])
+                    pending.append((pc + 1, params))
+                else:
+                    if not first:
+                        params = dict(params)
+                    first = False
+                    threads.append((pc, params, numMatched, None))
+
+        threads = []
+        addThread(threads, set(), 0, {}, 0)
+        mo = MatchObject()
+        for srcCall in calls:
+            for pc, params, numMatched, firstSkipped in threads:
+                if program[pc][0] == OP_MATCH:
+                    mo.params = params
+                    return mo
             if verbose:
-                print(refCall)
-            skippedSrcCalls = []
-            while True:
+                print('\t%s %s%r = %r' % srcCall)
+            nextThreads = []
+            seen = set()
+            for pc, params, numMatched, firstSkipped in threads:
+                call = program[pc][1]
+                mo.params = params
+                if call.match(srcCall, mo):
+                    if verbose:
+                        print(call)
+                    addThread(nextThreads, seen, pc + 1, params, numMatched + 1)
+                else:
+                    key = threadKey(pc, params)
+                    if key in seen:
+                        continue
+                    seen.add(key)
+                    nextThreads.append((pc, params, numMatched, firstSkipped or srcCall))
+            threads = nextThreads
+
+        best = None
+        for thread in threads:
+            pc, params, numMatched, firstSkipped = thread
+            if program[pc][0] == OP_MATCH:
+                mo.params = params
+                return mo
+            if best is None or numMatched > best[2]:
+                best = thread
+        pc, params, numMatched, firstSkipped = best
+        refCall = program[pc][1]
+        if firstSkipped is not None:
+            raise TraceMismatch('missing call\n  %s\nfound\n  %s)' % (refCall, firstSkipped))
+        else:
+            raise TraceMismatch('missing call\n  %s' % refCall)
+
+    def _matchFrames(self, calls, processes):
+        '''Match the reference frame by frame, anchoring the N-th reference
+        SwapBuffers on the N-th source SwapBuffers, and matching all frames
+        after the first concurrently.
+
+        Returns None whenever the anchored match fails or its wildcard
+        bindings conflict, so that the caller falls back to the sequential
+        scan, which reports mismatches exactly.'''
+
+        refFrames = splitFrames(self.calls, lambda call: call.functionName)
+        if len(refFrames) < 2:
+            return None
+        srcFrames = splitFrames(calls, lambda call: call[1])
+        if len(srcFrames) < len(refFrames):
+            return None
+
+        # The calls after the last reference SwapBuffers may match anywhere
+        # in the remaining source frames
+        last = len(refFrames) - 1
+        srcFrames[last:] = [list(itertools.chain.from_iterable(srcFrames[last:]))]
+
+        # The first frame, which usually creates the objects that later
+        # frames refer to, binds the parameters the other frames start from
+        mo = MatchObject()
+        try:
+            _matchSequence(refFrames[0], srcFrames[0], mo)
+        except TraceMismatch:
+            return None
+
+        jobs = [(refFrame, srcFrame, mo.params)
+                for refFrame, srcFrame in zip(refFrames[1:], srcFrames[1:])]
+        numSrcCalls = sum([len(srcFrame) for srcFrame in srcFrames[1:]])
+        processes = min(processes, os.cpu_count() or 1)
+        if numSrcCalls >= self.parallelThreshold and len(jobs) > 1 and processes > 1 and \
+           'fork' in multiprocessing.get_all_start_methods():
+            global _frameJobs
+            _frameJobs = jobs
+            try:
+                context = multiprocessing.get_context('fork')
+                with concurrent.futures.ProcessPoolExecutor(processes, context) as executor:
+                    chunksize = max(len(jobs) // (4 * processes), 1)
+                    results = list(executor.map(_matchForkedFrame, range(len(jobs)), chunksize = chunksize))
+            finally:
+                _frameJobs = []
+        else:
+            results = list(map(_matchFrame, jobs))
+
+        # Reconcile the bindings made independently by every frame
+        for params in results:
+            if params is None:
+                return None
+            for name, value in params.items():
                 try:
-                    srcCall = next(srcCalls)
-                except StopIteration:
-                    if skippedSrcCalls:
-                        raise TraceMismatch('missing call\n  %s\nfound\n  %s)' % (refCall, skippedSrcCalls[0]))
-                    else:
-                        raise TraceMismatch('missing call\n  %s' % refCall)
-                if verbose:
-                    print('\t%s %s%r = %r' % srcCall)
-                if refCall.match(srcCall, mo):
-                    break
+                    refValue = mo.params[name]
+                except KeyError:
+                    mo.params[name] = value
                 else:
-                    skippedSrcCalls.append(srcCall)
+                    if refValue != value:
+                        return None
+
         return mo
 
     def __str__(self):
         return ''.join(['%s\n' % call for call in self.calls])
 
 
+def _matchThread(job):
+    '''Match the calls of one thread, returning the parameters bound, and
+    the mismatch message or None.'''
+    refTrace, srcCalls, processes = job
+    try:
+        mo = refTrace.match(srcCalls, processes = processes)
+    except TraceMismatch as ex:
+        return None, str(ex)
+    return mo.params, None
+
+
+# Per-thread jobs, inherited by forked worker processes
+_threadJobs = []
+
+def _matchForkedThread(index):
+    return _matchThread(_threadJobs[index])
+
+
+class ThreadedTraceMatcher:
+    '''Reference made of `thread N { ... }` blocks, each matched
+    independently, and possibly concurrently, against the calls of the
+    source thread with the same id, so that the interleaving of threads
+    doesn't matter.  Wildcards bound by several threads must agree.'''
+
+    parallelThreshold = TraceMatcher.parallelThreshold
+
+    def __init__(self, threads):
+        self.threads = threads
+
+    def match(self, calls, verbose = False, threads = None, processes = 1):
+        if threads is None:
+            raise TraceMismatch('reference has per-thread calls, but the source has no thread ids')
+
+        jobs = []
+        for thread in sorted(self.threads):
+            try:
+                srcCalls = threads[thread]
+            except KeyError:
+                raise TraceMismatch('missing thread %u' % thread)
+            jobs.append((self.threads[thread], srcCalls, processes))
+
+        numSrcCalls = sum([len(srcCalls) for refTrace, srcCalls, processes_ in jobs])
+        processes = min(processes, os.cpu_count() or 1)
+        if verbose:
+            results = []
+            for thread, (refTrace, srcCalls, processes_) in zip(sorted(self.threads), jobs):
+                print('thread %u' % thread)
+                try:
+                    mo = refTrace.match(srcCalls, verbose)
+                except TraceMismatch as ex:
+                    results.append((None, str(ex)))
+                else:
+                    results.append((mo.params, None))
+        elif numSrcCalls >= self.parallelThreshold and len(jobs) > 1 and processes > 1 and \
+             'fork' in multiprocessing.get_all_start_methods():
+            global _threadJobs
+            # Workers can't fork workers of their own
+            _threadJobs = [(refTrace, srcCalls, 1) for refTrace, srcCalls, processes_ in jobs]
+            try:
+                context = multiprocessing.get_context('fork')
+                with concurrent.futures.ProcessPoolExecutor(min(processes, len(jobs)), context) as executor:
+                    results = list(executor.map(_matchForkedThread, range(len(jobs))))
+            finally:
+                _threadJobs = []
+        else:
+            results = list(map(_matchThread, jobs))
+
+        mo = MatchObject()
+        owners = {}
+        for thread, (params, error) in zip(sorted(self.threads), results):
+            if error is not None:
+                raise TraceMismatch('thread %u: %s' % (thread, error))
+            for name, value in params.items():
+                try:
+                    refValue = mo.params[name]
+                except KeyError:
+                    mo.params[name] = value
+                    owners[name] = thread
+                else:
+                    if refValue != value:
+                        raise TraceMismatch('parameter %s is %r in thread %u, but %r in thread %u' % (
+                            name, refValue, owners[name], value, thread))
+        return mo
+
+    def __str__(self):
+        s = ''
+        for thread in sorted(self.threads):
+            body = str(self.threads[thread])
+            body = ''.join(['    ' + line for line in body.splitlines(True)])
+            s += 'thread %u {\n%s}\n' % (thread, body)
+        return s
+
+
 #######################################################################
 
 EOF = -1
@@ -323,7 +851,7 @@ class ParseError(Exception):
         
 
 class Scanner:
-    """Stateless scanner."""
+    """Stateless scanner, over UTF-8 encoded bytes."""
 
     # should be overriden by derived classes
     tokens = []
@@ -335,34 +863,56 @@ class Scanner:
         flags = re.DOTALL
         if self.ignorecase:
             flags |= re.IGNORECASE
+        skips = [regexp for type, regexp, test_lit in self.tokens if type == SKIP]
+        tokens = [(type, regexp, test_lit) for type, regexp, test_lit in self.tokens if type != SKIP]
+        # A single match per token skips whitespace and comments, and then
+        # matches either a token, a symbol character, or the end of input
+        regexps = ['(' + regexp + ')' for type, regexp, test_lit in tokens] + ['(.)', '()']
         self.tokens_re = re.compile(
-            '|'.join(['(' + regexp + ')' for type, regexp, test_lit in self.tokens]),
+            ('(?:' + '|'.join(skips or ['(?!)']) + ')*(?:' + '|'.join(regexps) + ')').encode('ascii'),
              flags
         )
+        self.token_types = [None] + [(type, test_lit) for type, regexp, test_lit in tokens]
+        self.symbol_group = len(tokens) + 1
+        self.byte_symbols = dict([(ord(c), type) for c, type in self.symbols.items()])
 
     def next(self, buf, pos):
-        if pos >= len(buf):
-            return EOF, '', pos
+        '''Scan the token following pos, returning its type, its text, and
+        its start and end positions.'''
         mo = self.tokens_re.match(buf, pos)
-        if mo:
-            text = mo.group()
-            type, regexp, test_lit = self.tokens[mo.lastindex - 1]
-            pos = mo.end()
+        group = mo.lastindex
+        start, end = mo.span(group)
+        if group < self.symbol_group:
+            type, test_lit = self.token_types[group]
+            text = buf[start:end].decode('utf-8', 'replace')
             if test_lit:
                 type = self.literals.get(text, type)
-            return type, text, pos
+            return type, text, start, end
+        elif group == self.symbol_group:
+            c = buf[start]
+            return self.byte_symbols.get(c, None), chr(c), start, end
         else:
-            c = buf[pos]
-            return self.symbols.get(c, None), c, pos + 1
+            return EOF, '', start, end
 
 
 class Token:
 
-    def __init__(self, type, text, line, col):
+    def __init__(self, type, text, lexer, pos):
         self.type = type
         self.text = text
-        self.line = line
-        self.col = col
+        self.lexer = lexer
+        self.pos = pos
+
+    # Line and column are only needed for error messages, so they are only
+    # computed then
+
+    @property
+    def line(self):
+        return self.lexer.position(self.pos)[0]
+
+    @property
+    def col(self):
+        return self.lexer.position(self.pos)[1]
 
 
 class Lexer:
@@ -371,12 +921,11 @@ class Lexer:
     scanner = None
     tabsize = 8
 
-    newline_re = re.compile(r'\r\n?|\n')
+    newline_re = re.compile(br'\r\n?|\n')
 
     def __init__(self, buf = None, pos = 0, filename = None, fp = None):
         if fp is not None:
-            # read whole file into memory
-            buf = fp.read()
+            buf = self.read(fp)
             pos = 0
 
             if filename is None:
@@ -385,56 +934,64 @@ class Lexer:
                 except AttributeError:
                     filename = None
 
+        if isinstance(buf, str):
+            buf = buf.encode('utf-8')
+
         self.buf = buf
         self.pos = pos
-        self.line = 1
-        self.col = 1
         self.filename = filename
 
+    @staticmethod
+    def read(fp):
+        '''Map regular files into memory, instead of copying them, and read
+        anything else, such as pipes, as is.'''
+        stream = getattr(fp, 'buffer', fp)
+        try:
+            fileno = stream.fileno()
+            st = os.fstat(fileno)
+        except (AttributeError, OSError, ValueError):
+            pass
+        else:
+            if stat.S_ISREG(st.st_mode) and st.st_size > 0 and stream.tell() == 0:
+                return mmap.mmap(fileno, 0, access = mmap.ACCESS_READ)
+        return stream.read()
+
     def __next__(self):
-        while True:
-            # save state
-            pos = self.pos
-            line = self.line
-            col = self.col
-
-            type, text, endpos = self.scanner.next(self.buf, pos)
-            assert pos + len(text) == endpos
-            self.consume(text)
-            type, text = self.filter(type, text)
-            self.pos = endpos
-
-            if type == SKIP:
-                continue
-            elif type is None:
-                msg = 'unexpected char '
-                if text >= ' ' and text <= '~':
-                    msg += "'%s'" % text
-                else:
-                    msg += "0x%X" % ord(text)
-                raise ParseError(msg, self.filename, line, col)
+        type, text, pos, endpos = self.scanner.next(self.buf, self.pos)
+        self.pos = endpos
+        if type is None:
+            msg = 'unexpected char '
+            if text >= ' ' and text <= '~':
+                msg += "'%s'" % text
             else:
-                break
-        return Token(type = type, text = text, line = line, col = col)
-
-    def consume(self, text):
-        # update line number
-        pos = 0
-        for mo in self.newline_re.finditer(text, pos):
-            self.line += 1
-            self.col = 1
-            pos = mo.end()
-
-        # update column number
+                msg += "0x%X" % ord(text)
+            line, col = self.position(pos)
+            raise ParseError(msg, self.filename, line, col)
+        type, text = self.filter(type, text)
+        return Token(type, text, self, pos)
+
+    def position(self, pos):
+        '''Compute the line and column of a position.'''
+        line = 1
+        start = 0
+        for mo in self.newline_re.finditer(self.buf, 0, pos):
+            line += 1
+            start = mo.end()
+
+        # expand tabs
+        text = self.buf[start:pos].decode('utf-8', 'replace')
+        col = 1
+        start = 0
         while True:
-            tabpos = text.find('\t', pos)
+            tabpos = text.find('\t', start)
             if tabpos == -1:
                 break
-            self.col += tabpos - pos
-            self.col = ((self.col - 1)//self.tabsize + 1)*self.tabsize + 1
-            pos = tabpos + 1
-        self.col += len(text) - pos
-    
+            col += tabpos - start
+            col = ((col - 1)//self.tabsize + 1)*self.tabsize + 1
+            start = tabpos + 1
+        col += len(text) - start
+        return line, col
+
     def filter(self, type, text):
         return type, text
 
@@ -469,7 +1026,7 @@ class Parser:
 
 #######################################################################
 
-ID, NUMBER, HEXNUM, STRING, WSTRING, WILDCARD, LPAREN, RPAREN, LCURLY, RCURLY, COMMA, AMP, EQUAL, PLUS, VERT, BLOB, MISSING = range(17)
+ID, NUMBER, HEXNUM, STRING, WSTRING, WILDCARD, LPAREN, RPAREN, LCURLY, RCURLY, COMMA, AMP, EQUAL, PLUS, VERT, BLOB, MISSING, THREAD = range(18)
 
 
 class CallScanner(Scanner):
@@ -499,6 +1056,9 @@ class CallScanner(Scanner):
 
         # Wildcard
         (WILDCARD, r'<[^>]*>', False),
+
+        # Thread ids, as in `apitrace dump --thread-ids`
+        (THREAD, r'@[0-9]+', False),
     ]
 
     # symbol table
@@ -547,17 +1107,66 @@ class TraceParser(Parser):
     def __init__(self, stream):
         lexer = CallLexer(fp = stream)
         Parser.__init__(self, lexer)
+        # Thread id of the call being parsed
+        self.thread = None
 
     def eof(self):
         return self.match(EOF)
 
     def parse(self):
         while not self.eof():
-            self.parse_call()
+            self.parse_item()
         return TraceMatcher(self.calls)
 
-    def parse_call(self):
-        if self.lookahead.type == NUMBER:
+    def parse_item(self):
+        '''Parse a call, a `repeat N[+| , M] { ... }` block of calls, or a
+        `thread N { ... }` block of the calls of a thread.'''
+        if self.match(ID) and self.lookahead.text in ('repeat', 'thread'):
+            token = self.consume()
+            if not self.match(LPAREN):
+                if token.text == 'repeat':
+                    self.parse_repeat()
+                else:
+                    self.parse_thread()
+                return
+            functionName = token.text
+        else:
+            functionName = None
+        self.parse_call(functionName)
+
+    def parse_thread(self):
+        token = self.consume(NUMBER)
+        thread = int(token.text)
+        self.consume(LCURLY)
+        self.beginThread(thread)
+        while not self.match(RCURLY):
+            self.parse_item()
+        self.consume(RCURLY)
+        self.endThread(thread)
+
+    def parse_repeat(self):
+        minCount = int(self.consume(NUMBER).text)
+        if self.match(PLUS):
+            self.consume()
+            maxCount = None
+        elif self.match(COMMA):
+            self.consume()
+            maxCount = int(self.consume(NUMBER).text)
+        else:
+            maxCount = minCount
+        if minCount < 0 or (maxCount is not None and maxCount < minCount):
+            self.error()
+        self.consume(LCURLY)
+        self.beginRepeat()
+        while not self.match(RCURLY):
+            self.parse_item()
+        self.consume(RCURLY)
+        self.endRepeat(minCount, maxCount)
+
+    def parse_call(self, functionName = None):
+        if functionName is not None:
+            callNo = None
+        elif self.lookahead.type == NUMBER:
             token = self.consume()
             callNo = self.handleInt(int(token.text))
         elif self.lookahead.type == WILDCARD:
@@ -565,8 +1174,14 @@ class TraceParser(Parser):
             callNo = self.handleWildcard((token.text[1:-1]))
         else:
             callNo = None
-        
-        functionName = self.consume(ID).text
+
+        if self.match(THREAD):
+            self.thread = int(self.consume().text[1:])
+        else:
+            self.thread = None
+
+        if functionName is None:
+            functionName = self.consume(ID).text
 
         args = self.parse_sequence(LPAREN, RPAREN, self.parse_pair)
 
@@ -732,15 +1347,31 @@ class TraceParser(Parser):
     def handleCall(self, callNo, functionName, args, ret):
         raise NotImplementedError
 
+    def beginRepeat(self):
+        self.error()
+
+    def endRepeat(self, minCount, maxCount):
+        raise NotImplementedError
+
+    def beginThread(self, thread):
+        self.error()
+
+    def endThread(self, thread):
+        raise NotImplementedError
+
 
 class RefTraceParser(TraceParser):
 
     def __init__(self, fileName):
         TraceParser.__init__(self, open(fileName, 'rt'))
         self.calls = []
+        self.outerCalls = []
+        self.threads = {}
 
     def parse(self):
         TraceParser.parse(self)
+        if self.threads:
+            return ThreadedTraceMatcher(self.threads)
         return TraceMatcher(self.calls)
 
     def handleID(self, value):
@@ -762,6 +1393,11 @@ class RefTraceParser(TraceParser):
         return OffsetMatcher(value, offset)
 
     def handleArray(self, value):
+        if len(value) > 1:
+            if all([type(element) is ApproxMatcher for element in value]):
+                return FloatArrayMatcher(value)
+            if all([type(element) is LiteralMatcher and type(element.refValue) is int for element in value]):
+                return IntArrayMatcher(value)
         return ArrayMatcher(value)
 
     def handleStruct(self, value):
@@ -770,7 +1406,39 @@ class RefTraceParser(TraceParser):
     def handleWildcard(self, name):
         return WildcardMatcher(name)
 
+    def beginRepeat(self):
+        self.outerCalls.append(self.calls)
+        self.calls = []
+
+    def endRepeat(self, minCount, maxCount):
+        repeat = RepeatMatcher(self.calls, minCount, maxCount)
+        self.calls = self.outerCalls.pop()
+        self.calls.append(repeat)
+
+    def beginThread(self, thread):
+        if self.outerCalls:
+            self.refError('thread blocks can\'t be nested or repeated')
+        if self.calls:
+            self.refError('thread block after calls outside thread blocks')
+        if thread in self.threads:
+            self.refError('thread %u declared twice' % thread)
+        self.outerCalls.append(self.calls)
+        self.calls = []
+
+    def endThread(self, thread):
+        self.threads[thread] = TraceMatcher(self.calls)
+        self.calls = self.outerCalls.pop()
+
+    def refError(self, msg):
+        raise ParseError(
+            msg = msg,
+            filename = self.lexer.filename,
+            line = self.lookahead.line,
+            col = self.lookahead.col)
+
     def handleCall(self, callNo, functionName, args, ret):
+        if self.threads and not self.outerCalls:
+            self.refError('call outside thread blocks')
         call = CallMatcher(callNo, functionName, args, ret)
         self.calls.append(call)
 
@@ -780,6 +1448,10 @@ class SrcTraceParser(TraceParser):
     def __init__(self, stream):
         TraceParser.__init__(self, stream)
         self.calls = []
+        # Calls of every thread, when dumped with --thread-ids
+        self.threads = {}
+        # Equal strings share one object, so their hash is only computed once
+        self.strings = {}
 
     def parse(self):
         TraceParser.parse(self)
@@ -795,7 +1467,7 @@ class SrcTraceParser(TraceParser):
         return float(value)
 
     def handleString(self, value):
-        return value
+        return self.strings.setdefault(value, value)
 
     def handleBitmask(self, value):
         return value
@@ -809,6 +1481,8 @@ class SrcTraceParser(TraceParser):
     def handleCall(self, callNo, functionName, args, ret):
         call = (callNo, functionName, args, ret)
         self.calls.append(call)
+        if self.thread is not None:
+            self.threads.setdefault(self.thread, []).append(call)
 
 
 def main():
@@ -825,6 +1499,10 @@ def main():
         action="store_true",
         dest="verbose", default=True,
         help="verbose output")
+    optparser.add_option(
+        '-j', '--processes', metavar='N',
+        type='int', dest='processes', default=1,
+        help='match long traces with up to N processes [default=%default]')
     (options, args) = optparser.parse_args(sys.argv[1:])
 
     if len(args) != 2:
@@ -840,7 +1518,10 @@ def main():
         sys.stdout.write('\n')
 
     if srcFileName.endswith('.trace'):
-        cmd = [options.apitrace, 'dump', '--verbose', '--color=never', srcFileName]
+        cmd = [options.apitrace, 'dump', '--verbose', '--color=never']
+        if isinstance(refTrace, ThreadedTraceMatcher):
+            cmd += ['--thread-ids']
+        cmd += [srcFileName]
         p = subprocess.Popen(cmd, stdout=subprocess.PIPE, universal_newlines=True)
         srcStream = p.stdout
     else:
@@ -854,7 +1535,7 @@ def main():
 
     if options.verbose:
         sys.stdout.write('// Matching\n')
-    mo = refTrace.match(srcTrace, options.verbose)
+    mo = refTrace.match(srcTrace, options.verbose, srcParser.threads, options.processes)
     if options.verbose:
         sys.stdout.write('\n')
 
@@ -28,9 +28,14 @@
 
 
 import optparse
+import os.path
 import subprocess
 import sys
 
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), os.path.pardir))
+
+from base_driver import digest_lines
+
 
 def main():
 
@@ -42,6 +47,11 @@ def main():
         '--apitrace', metavar='PROGRAM',
         type='string', dest='apitrace', default='apitrace',
         help='path to apitrace executable')
+    optparser.add_option(
+        '--sha256',
+        action="store_true",
+        dest="sha256", default=False,
+        help="expect the output digest and line count, instead of the whole output")
     (options, args) = optparser.parse_args(sys.argv[1:])
     if not args:
         optparser.error('an argument must be specified')
@@ -49,7 +59,12 @@ def main():
     sys.stdout.write(' '.join(args) + '\n')
     sys.stdout.flush()
     cmd = [options.apitrace] + args
-    p = subprocess.Popen(cmd)
+    if options.sha256:
+        p = subprocess.Popen(cmd, stdout=subprocess.PIPE, universal_newlines=True)
+        digest, numLines = digest_lines(p.stdout)
+        sys.stdout.write('#sha256 %s %u\n' % (digest, numLines))
+    else:
+        p = subprocess.Popen(cmd)
     p.wait()
     sys.exit(p.returncode)
 